@@ -0,0 +1,490 @@
+#include "allocation-profiler.h"
+#include "atomic-list-ptr.h"
+#include "list-ptr.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ct::bench {
+
+namespace {
+
+struct Payload {
+  explicit Payload(int data)
+      : data(data) {}
+
+  int data;
+};
+
+inline constexpr int magic = 42;
+
+struct ListPtrOps {
+  using Ptr = ListPtr<Payload>;
+
+  static Ptr make() {
+    return makeListPtr<Payload>(magic);
+  }
+
+  static std::size_t useCount(const Ptr& ptr) {
+    return ptr.useCount();
+  }
+};
+
+template <typename Links>
+struct LinkedListPtrOps {
+  using Ptr = ListPtr<Payload, std::default_delete<Payload>, Links>;
+
+  static Ptr make() {
+    return Ptr(new Payload(magic));
+  }
+
+  static std::size_t useCount(const Ptr& ptr) {
+    return ptr.useCount();
+  }
+};
+
+using DoublyLinkedOps = LinkedListPtrOps<DoublyLinked>;
+using SinglyLinkedOps = LinkedListPtrOps<SinglyLinked>;
+using HybridLinkedOps = LinkedListPtrOps<HybridLinked<>>;
+
+struct AtomicListPtrOps {
+  using Ptr = AtomicListPtr<Payload>;
+
+  static Ptr make() {
+    return makeAtomicListPtr<Payload>(magic);
+  }
+
+  static std::size_t useCount(const Ptr& ptr) {
+    return ptr.useCount();
+  }
+};
+
+struct SharedPtrOps {
+  using Ptr = std::shared_ptr<Payload>;
+
+  static Ptr make() {
+    return std::make_shared<Payload>(magic);
+  }
+
+  static std::size_t useCount(const Ptr& ptr) {
+    return static_cast<std::size_t>(ptr.use_count());
+  }
+};
+
+struct UniquePtrOps {
+  using Ptr = std::unique_ptr<Payload>;
+
+  static Ptr make() {
+    return std::make_unique<Payload>(magic);
+  }
+};
+
+enum class Cache {
+  Hot,
+  Cold,
+};
+
+// With a hot cache operations are timed in batches to amortize the cost of `PauseTiming`.
+// With a cold cache every operation is a batch of its own, preceded by a cache flush and timed manually,
+// since the overhead of `PauseTiming` would be comparable to the cost of the operation itself.
+template <Cache C>
+inline constexpr std::size_t batch_size = C == Cache::Cold ? 1 : 256;
+
+inline constexpr benchmark::IterationCount cold_iterations = 1000;
+
+// Should be larger than the last level cache of the machine running the benchmarks.
+inline constexpr std::size_t flush_size = std::size_t(64) << 20;
+
+void flushCaches() {
+  static std::vector<char> buffer(flush_size);
+  for (std::size_t i = 0; i < buffer.size(); i += 64) {
+    ++buffer[i];
+  }
+  benchmark::ClobberMemory();
+}
+
+// Uninitialized storage, so that construction can be timed separately from destruction.
+template <typename T>
+union Slot {
+  Slot() {}
+
+  ~Slot() {}
+
+  T value;
+};
+
+template <typename Ptr>
+class Slots {
+public:
+  explicit Slots(std::size_t size)
+      : slots(size) {}
+
+  template <typename... Args>
+  void construct(std::size_t i, Args&&... args) {
+    std::construct_at(&slots[i].value, std::forward<Args>(args)...);
+    benchmark::DoNotOptimize(slots[i].value);
+  }
+
+  void destroy(std::size_t i) {
+    std::destroy_at(&slots[i].value);
+  }
+
+  void destroyRange(std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i) {
+      destroy(i);
+    }
+  }
+
+  void destroyFirst(std::size_t count) {
+    destroyRange(0, count);
+  }
+
+  Ptr& operator[](std::size_t i) {
+    return slots[i].value;
+  }
+
+private:
+  std::vector<Slot<Ptr>> slots;
+};
+
+template <typename Ptr>
+std::vector<Ptr> makeGroup(Ptr owner, std::size_t size) {
+  std::vector<Ptr> group;
+  group.reserve(size);
+  for (std::size_t i = 1; i < size; ++i) {
+    group.push_back(owner);
+  }
+  group.push_back(std::move(owner));
+  return group;
+}
+
+// Bounds the memory taken by the groups of a benchmark.
+inline constexpr std::size_t max_group_owners = std::size_t(1) << 20;
+
+// Groups of `size` owners of separate objects, one for every operation in a batch, so that an operation works
+// on a group of exactly `size` owners, to which it adds or from which it removes at most one owner of its own.
+// Groups larger than `max_group_owners / batch_size` owners are shared by several operations of a batch,
+// but they grow by less than 0.1% of their size while it runs.
+template <typename Ops>
+class Groups {
+public:
+  using Ptr = typename Ops::Ptr;
+
+  explicit Groups(std::size_t size)
+      : groups(std::clamp(max_group_owners / size, std::size_t(1), batch_size<Cache::Hot>)) {
+    for (auto& group : groups) {
+      group = makeGroup(Ops::make(), size);
+    }
+  }
+
+  // An owner from the group of the i-th operation in a batch.
+  const Ptr& operator[](std::size_t i) const {
+    const auto& group = groups[i % groups.size()];
+    return group[i / groups.size() % group.size()];
+  }
+
+private:
+  std::vector<std::vector<Ptr>> groups;
+};
+
+std::size_t threadAllocations() {
+  return profiling::threadAllocationCounters().allocations;
+}
+
+// Calls `set_up()` before each batch, `op(i)` for the i-th operation in the batch
+// and `tear_down(done)` after the batch, where `done` is the number of performed operations.
+// Only `op` is timed, and only its allocations are counted: the `allocations` counter is their number
+// per operation, which shows e.g. the promotion of `HybridLinked` groups.
+template <Cache C, typename SetUp, typename Op, typename TearDown>
+void runBatched(benchmark::State& state, SetUp set_up, Op op, TearDown tear_down) {
+  std::size_t allocations = 0;
+
+  if constexpr (C == Cache::Cold) {
+    using Clock = std::chrono::steady_clock;
+
+    for (auto _ : state) {
+      set_up();
+      flushCaches();
+      std::size_t allocations_before = threadAllocations();
+      auto start = Clock::now();
+      op(0);
+      auto end = Clock::now();
+      allocations += threadAllocations() - allocations_before;
+      tear_down(1);
+      state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+  } else {
+    std::size_t i = 0;
+    set_up();
+    std::size_t allocations_before = threadAllocations();
+
+    for (auto _ : state) {
+      op(i);
+      if (++i == batch_size<C>) {
+        state.PauseTiming();
+        allocations += threadAllocations() - allocations_before;
+        tear_down(i);
+        set_up();
+        allocations_before = threadAllocations();
+        i = 0;
+        state.ResumeTiming();
+      }
+    }
+
+    allocations += threadAllocations() - allocations_before;
+    tear_down(i);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["allocations"] =
+      benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+template <typename Ops, Cache C>
+void CopyConstruct(benchmark::State& state) {
+  using Ptr = typename Ops::Ptr;
+  const Groups<Ops> groups(static_cast<std::size_t>(state.range(0)));
+  Slots<Ptr> copies(batch_size<Cache::Hot>);
+
+  runBatched<C>(
+      state,
+      [] {},
+      [&](std::size_t i) { copies.construct(i, groups[i]); },
+      [&](std::size_t done) { copies.destroyFirst(done); }
+  );
+}
+
+template <typename Ops, Cache C>
+void MoveConstruct(benchmark::State& state) {
+  using Ptr = typename Ops::Ptr;
+  const Groups<Ops> groups(static_cast<std::size_t>(state.range(0)));
+  Slots<Ptr> sources(batch_size<Cache::Hot>);
+  Slots<Ptr> targets(batch_size<Cache::Hot>);
+
+  runBatched<C>(
+      state,
+      [&] {
+        for (std::size_t i = 0; i < batch_size<C>; ++i) {
+          sources.construct(i, groups[i]);
+        }
+      },
+      [&](std::size_t i) { targets.construct(i, std::move(sources[i])); },
+      [&](std::size_t done) {
+        targets.destroyFirst(done);
+        sources.destroyFirst(batch_size<C>);
+      }
+  );
+}
+
+template <typename Ops, Cache C>
+void UniqueMoveConstruct(benchmark::State& state) {
+  using Ptr = typename Ops::Ptr;
+  Slots<Ptr> sources(batch_size<Cache::Hot>);
+  Slots<Ptr> targets(batch_size<Cache::Hot>);
+
+  runBatched<C>(
+      state,
+      [&] {
+        for (std::size_t i = 0; i < batch_size<C>; ++i) {
+          sources.construct(i, Ops::make());
+        }
+      },
+      [&](std::size_t i) { targets.construct(i, std::move(sources[i])); },
+      [&](std::size_t done) {
+        targets.destroyFirst(done);
+        sources.destroyFirst(batch_size<C>);
+      }
+  );
+}
+
+// Every target leaves a group of another object, which is kept alive by the single owner in `others`,
+// so the destruction of the previously owned object is not measured.
+template <typename Ops, Cache C>
+void CopyAssign(benchmark::State& state) {
+  using Ptr = typename Ops::Ptr;
+  const Groups<Ops> groups(static_cast<std::size_t>(state.range(0)));
+  const Groups<Ops> others(1);
+  Slots<Ptr> targets(batch_size<Cache::Hot>);
+
+  runBatched<C>(
+      state,
+      [&] {
+        for (std::size_t i = 0; i < batch_size<C>; ++i) {
+          targets.construct(i, others[i]);
+        }
+      },
+      [&](std::size_t i) {
+        targets[i] = groups[i];
+        benchmark::DoNotOptimize(targets[i]);
+      },
+      [&](std::size_t) { targets.destroyFirst(batch_size<C>); }
+  );
+}
+
+// Destruction of an owner which is not the last one in its group.
+template <typename Ops, Cache C>
+void DestroyOwner(benchmark::State& state) {
+  using Ptr = typename Ops::Ptr;
+  const Groups<Ops> groups(static_cast<std::size_t>(state.range(0)));
+  Slots<Ptr> owners(batch_size<Cache::Hot>);
+
+  runBatched<C>(
+      state,
+      [&] {
+        for (std::size_t i = 0; i < batch_size<C>; ++i) {
+          owners.construct(i, groups[i]);
+        }
+      },
+      [&](std::size_t i) { owners.destroy(i); },
+      [&](std::size_t done) { owners.destroyRange(done, batch_size<C>); }
+  );
+}
+
+template <typename Ops, Cache C>
+void DestroyLastOwner(benchmark::State& state) {
+  using Ptr = typename Ops::Ptr;
+  Slots<Ptr> owners(batch_size<Cache::Hot>);
+
+  runBatched<C>(
+      state,
+      [&] {
+        for (std::size_t i = 0; i < batch_size<C>; ++i) {
+          owners.construct(i, Ops::make());
+        }
+      },
+      [&](std::size_t i) { owners.destroy(i); },
+      [&](std::size_t done) { owners.destroyRange(done, batch_size<C>); }
+  );
+}
+
+template <typename Ops, Cache C>
+void UseCount(benchmark::State& state) {
+  const Groups<Ops> groups(static_cast<std::size_t>(state.range(0)));
+
+  runBatched<C>(
+      state,
+      [] {},
+      [&](std::size_t i) {
+        auto count = Ops::useCount(groups[i]);
+        benchmark::DoNotOptimize(count);
+      },
+      [](std::size_t) {}
+  );
+}
+
+template <typename Ops, Cache C>
+void Make(benchmark::State& state) {
+  using Ptr = typename Ops::Ptr;
+  Slots<Ptr> owners(batch_size<Cache::Hot>);
+
+  runBatched<C>(
+      state,
+      [] {},
+      [&](std::size_t i) { owners.construct(i, Ops::make()); },
+      [&](std::size_t done) { owners.destroyFirst(done); }
+  );
+}
+
+// All threads copy and destroy owners of the same object.
+template <typename Ops>
+void ContendedCopy(benchmark::State& state) {
+  using Ptr = typename Ops::Ptr;
+  static Ptr shared;
+
+  if (state.thread_index() == 0) {
+    shared = Ops::make();
+  }
+
+  for (auto _ : state) {
+    Ptr copy(shared);
+    benchmark::DoNotOptimize(copy);
+  }
+
+  if (state.thread_index() == 0) {
+    shared = Ptr();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void groupSizes(benchmark::internal::Benchmark* b) {
+  b->ArgName("owners")->RangeMultiplier(16)->Range(1, 1 << 20);
+}
+
+// Typical sizes of groups, for which the choice between link strategies matters.
+void smallGroupSizes(benchmark::internal::Benchmark* b) {
+  b->ArgName("owners")->DenseRange(2, 8, 2);
+}
+
+// Sizes on both sides of the threshold of `HybridLinked<>`: groups of fewer than `threshold` owners stay linked
+// when an owner is added to them, larger ones are promoted to a counted block by the first operation at the latest.
+void hybridGroupSizes(benchmark::internal::Benchmark* b) {
+  constexpr auto threshold = static_cast<std::int64_t>(HybridLinked<>::threshold);
+  b->ArgName("owners")->DenseRange(threshold - 3, threshold + 3);
+}
+
+} // namespace
+
+#define CT_BENCHMARK(name, ops)                                                                                        \
+  BENCHMARK_TEMPLATE(name, ops, Cache::Hot);                                                                           \
+  BENCHMARK_TEMPLATE(name, ops, Cache::Cold)->UseManualTime()->Iterations(cold_iterations)
+
+#define CT_CONTENDED_BENCHMARK(name, ops) BENCHMARK_TEMPLATE(name, ops)->ThreadRange(1, 16)->UseRealTime()
+
+#define CT_GROUP_BENCHMARK(name, ops, sizes)                                                                           \
+  BENCHMARK_TEMPLATE(name, ops, Cache::Hot)->Apply(sizes);                                                             \
+  BENCHMARK_TEMPLATE(name, ops, Cache::Cold)->Apply(sizes)->UseManualTime()->Iterations(cold_iterations)
+
+CT_GROUP_BENCHMARK(CopyConstruct, ListPtrOps, groupSizes);
+CT_GROUP_BENCHMARK(CopyConstruct, SharedPtrOps, groupSizes);
+
+CT_GROUP_BENCHMARK(MoveConstruct, ListPtrOps, groupSizes);
+CT_GROUP_BENCHMARK(MoveConstruct, SharedPtrOps, groupSizes);
+CT_BENCHMARK(UniqueMoveConstruct, UniquePtrOps);
+
+CT_GROUP_BENCHMARK(CopyAssign, ListPtrOps, groupSizes);
+CT_GROUP_BENCHMARK(CopyAssign, SharedPtrOps, groupSizes);
+
+CT_GROUP_BENCHMARK(DestroyOwner, ListPtrOps, groupSizes);
+CT_GROUP_BENCHMARK(DestroyOwner, SharedPtrOps, groupSizes);
+
+CT_BENCHMARK(DestroyLastOwner, ListPtrOps);
+CT_BENCHMARK(DestroyLastOwner, SharedPtrOps);
+CT_BENCHMARK(DestroyLastOwner, UniquePtrOps);
+
+CT_GROUP_BENCHMARK(UseCount, ListPtrOps, groupSizes);
+CT_GROUP_BENCHMARK(UseCount, SharedPtrOps, groupSizes);
+
+CT_BENCHMARK(Make, ListPtrOps);
+CT_BENCHMARK(Make, SharedPtrOps);
+CT_BENCHMARK(Make, UniquePtrOps);
+
+CT_CONTENDED_BENCHMARK(ContendedCopy, AtomicListPtrOps);
+CT_CONTENDED_BENCHMARK(ContendedCopy, SharedPtrOps);
+
+CT_GROUP_BENCHMARK(CopyConstruct, DoublyLinkedOps, smallGroupSizes);
+CT_GROUP_BENCHMARK(CopyConstruct, SinglyLinkedOps, smallGroupSizes);
+
+CT_GROUP_BENCHMARK(CopyAssign, DoublyLinkedOps, smallGroupSizes);
+CT_GROUP_BENCHMARK(CopyAssign, SinglyLinkedOps, smallGroupSizes);
+
+CT_GROUP_BENCHMARK(DestroyOwner, DoublyLinkedOps, smallGroupSizes);
+CT_GROUP_BENCHMARK(DestroyOwner, SinglyLinkedOps, smallGroupSizes);
+
+CT_GROUP_BENCHMARK(UseCount, DoublyLinkedOps, smallGroupSizes);
+CT_GROUP_BENCHMARK(UseCount, SinglyLinkedOps, smallGroupSizes);
+
+CT_GROUP_BENCHMARK(CopyConstruct, HybridLinkedOps, groupSizes);
+CT_GROUP_BENCHMARK(DestroyOwner, HybridLinkedOps, groupSizes);
+CT_GROUP_BENCHMARK(UseCount, HybridLinkedOps, groupSizes);
+
+CT_GROUP_BENCHMARK(CopyConstruct, HybridLinkedOps, hybridGroupSizes);
+CT_GROUP_BENCHMARK(DestroyOwner, HybridLinkedOps, hybridGroupSizes);
+CT_GROUP_BENCHMARK(UseCount, HybridLinkedOps, hybridGroupSizes);
+
+} // namespace ct::bench
@@ -0,0 +1,38 @@
+#include "list-ptr-differential.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+
+namespace {
+
+template <typename Links>
+void run(std::span<const std::uint8_t> bytes, const char* links) {
+  using namespace ct::test::differential;
+
+  ByteStream stream(bytes);
+  Model<Links> model;
+  while (!stream.empty()) {
+    model.step(stream);
+    if (auto mismatch = model.mismatch()) {
+      std::fprintf(stderr, "ListPtr with %s differs from std::shared_ptr %s\n", links, mismatch->c_str());
+      std::abort();
+    }
+  }
+  if (auto leak = model.tearDown()) {
+    std::fprintf(stderr, "ListPtr with %s differs from std::shared_ptr %s\n", links, leak->c_str());
+    std::abort();
+  }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+  std::span bytes(data, size);
+  run<ct::DoublyLinked>(bytes, "DoublyLinked");
+  run<ct::SinglyLinked>(bytes, "SinglyLinked");
+  run<ct::HybridLinked<2>>(bytes, "HybridLinked<2>");
+  return 0;
+}
@@ -0,0 +1,271 @@
+#include "allocation-profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+struct ThreadState {
+  std::size_t allocations;
+  std::size_t deallocations;
+  std::size_t allocated_bytes;
+  std::size_t deallocated_bytes;
+  std::ptrdiff_t live_bytes;
+  std::ptrdiff_t peak_live_bytes;
+  // Set while the profiler updates its own data structures, so that their allocations are not counted.
+  bool paused;
+};
+
+thread_local constinit ThreadState state{};
+
+// Every block is prefixed with a header, which stores its size, so that deallocations are counted in bytes
+// even when the unsized `operator delete` is called.
+constexpr std::size_t headerSize(std::size_t alignment) {
+  return std::max(alignment, alignof(std::max_align_t));
+}
+
+void* allocate(std::size_t count, std::size_t alignment) noexcept {
+  std::size_t header = headerSize(alignment);
+  std::size_t total = (header + count + header - 1) / header * header;
+  auto* block = static_cast<std::byte*>(std::aligned_alloc(header, total));
+  if (!block) {
+    return nullptr;
+  }
+  std::byte* ptr = block + header;
+  std::memcpy(ptr - sizeof(count), &count, sizeof(count));
+
+  if (!state.paused) {
+    ++state.allocations;
+    state.allocated_bytes += count;
+    state.live_bytes += static_cast<std::ptrdiff_t>(count);
+    state.peak_live_bytes = std::max(state.peak_live_bytes, state.live_bytes);
+  }
+  return ptr;
+}
+
+void deallocate(void* ptr, std::size_t alignment) noexcept {
+  if (!ptr) {
+    return;
+  }
+  auto* bytes = static_cast<std::byte*>(ptr);
+  std::size_t count;
+  std::memcpy(&count, bytes - sizeof(count), sizeof(count));
+
+  if (!state.paused) {
+    ++state.deallocations;
+    state.deallocated_bytes += count;
+    state.live_bytes -= static_cast<std::ptrdiff_t>(count);
+  }
+  std::free(bytes - headerSize(alignment));
+}
+
+void* allocateOrThrow(std::size_t count, std::size_t alignment) {
+  void* ptr = allocate(count, alignment);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+struct PauseGuard {
+  PauseGuard()
+      : was_paused(std::exchange(state.paused, true)) {}
+
+  PauseGuard(const PauseGuard&) = delete;
+  PauseGuard& operator=(const PauseGuard&) = delete;
+
+  ~PauseGuard() {
+    state.paused = was_paused;
+  }
+
+private:
+  bool was_paused;
+};
+
+std::mutex sites_mutex;
+std::vector<ct::profiling::AllocationSiteStats> sites;
+
+void defaultBudgetHandler(const ct::profiling::AllocationBudgetViolation& violation) {
+  std::fprintf(
+      stderr,
+      "%s:%u: allocation budget exceeded in %s: %zu allocations (%zu bytes), at most %zu expected\n",
+      violation.location.file_name(),
+      static_cast<unsigned>(violation.location.line()),
+      violation.location.function_name(),
+      violation.counters.allocations,
+      violation.counters.allocated_bytes,
+      violation.budget
+  );
+  std::abort();
+}
+
+std::atomic<ct::profiling::AllocationBudgetHandler> budget_handler = &defaultBudgetHandler;
+
+} // namespace
+
+void* operator new(std::size_t count) {
+  return allocateOrThrow(count, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t count) {
+  return operator new(count);
+}
+
+void* operator new(std::size_t count, const std::nothrow_t&) noexcept {
+  return allocate(count, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t count, const std::nothrow_t& token) noexcept {
+  return operator new(count, token);
+}
+
+void* operator new(std::size_t count, std::align_val_t alignment) {
+  return allocateOrThrow(count, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t count, std::align_val_t alignment) {
+  return operator new(count, alignment);
+}
+
+void* operator new(std::size_t count, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return allocate(count, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t count, std::align_val_t alignment, const std::nothrow_t& token) noexcept {
+  return operator new(count, alignment, token);
+}
+
+void operator delete(void* ptr) noexcept {
+  deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete[](void* ptr) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept {
+  deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+  operator delete(ptr, alignment);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+  operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+  operator delete(ptr, alignment);
+}
+
+namespace ct::profiling {
+
+AllocationCounters threadAllocationCounters() {
+  return {
+      .allocations = state.allocations,
+      .deallocations = state.deallocations,
+      .allocated_bytes = state.allocated_bytes,
+      .deallocated_bytes = state.deallocated_bytes,
+      .peak_live_bytes = static_cast<std::size_t>(std::max<std::ptrdiff_t>(state.peak_live_bytes, 0)),
+  };
+}
+
+AllocationScope::AllocationScope(std::source_location location)
+    : site(location)
+    , start(threadAllocationCounters())
+    , start_live_bytes(state.live_bytes)
+    , outer_peak_live_bytes(std::exchange(state.peak_live_bytes, state.live_bytes)) {}
+
+AllocationScope::~AllocationScope() {
+  AllocationCounters result = counters();
+  state.peak_live_bytes = std::max(state.peak_live_bytes, outer_peak_live_bytes);
+
+  PauseGuard pause;
+  std::lock_guard lock(sites_mutex);
+  auto it = std::find_if(sites.begin(), sites.end(), [&](const AllocationSiteStats& stats) {
+    return stats.line == site.line() && std::string_view(stats.file) == site.file_name() &&
+           std::string_view(stats.function) == site.function_name();
+  });
+  if (it == sites.end()) {
+    it = sites.insert(
+        sites.end(),
+        AllocationSiteStats{
+            .file = site.file_name(),
+            .line = static_cast<unsigned>(site.line()),
+            .function = site.function_name(),
+            .scopes = 0,
+            .counters = {},
+        }
+    );
+  }
+  ++it->scopes;
+  it->counters.allocations += result.allocations;
+  it->counters.deallocations += result.deallocations;
+  it->counters.allocated_bytes += result.allocated_bytes;
+  it->counters.deallocated_bytes += result.deallocated_bytes;
+  it->counters.peak_live_bytes = std::max(it->counters.peak_live_bytes, result.peak_live_bytes);
+}
+
+AllocationCounters AllocationScope::counters() const {
+  return {
+      .allocations = state.allocations - start.allocations,
+      .deallocations = state.deallocations - start.deallocations,
+      .allocated_bytes = state.allocated_bytes - start.allocated_bytes,
+      .deallocated_bytes = state.deallocated_bytes - start.deallocated_bytes,
+      .peak_live_bytes =
+          static_cast<std::size_t>(std::max<std::ptrdiff_t>(state.peak_live_bytes - start_live_bytes, 0)),
+  };
+}
+
+const std::source_location& AllocationScope::location() const {
+  return site;
+}
+
+std::vector<AllocationSiteStats> allocationSiteStats() {
+  std::lock_guard lock(sites_mutex);
+  return sites;
+}
+
+void resetAllocationSiteStats() {
+  PauseGuard pause;
+  std::lock_guard lock(sites_mutex);
+  sites.clear();
+  sites.shrink_to_fit();
+}
+
+AllocationBudgetHandler setAllocationBudgetHandler(AllocationBudgetHandler handler) {
+  return budget_handler.exchange(handler);
+}
+
+ScopedAllocationBudget::ScopedAllocationBudget(std::size_t max_allocations, std::source_location location)
+    : max_allocations(max_allocations)
+    , scope(location) {}
+
+ScopedAllocationBudget::~ScopedAllocationBudget() {
+  AllocationCounters result = scope.counters();
+  if (result.allocations > max_allocations) {
+    budget_handler.load()({max_allocations, result, scope.location()});
+  }
+}
+
+AllocationCounters ScopedAllocationBudget::counters() const {
+  return scope.counters();
+}
+
+} // namespace ct::profiling
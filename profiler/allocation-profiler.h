@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <source_location>
+#include <vector>
+
+// Allocation profiler, which replaces the global `operator new` and `operator delete` of the program it is linked into.
+// It does not depend on GTest, so the benchmarks use it as well: budget violations are reported through a handler,
+// which tests may replace.
+
+namespace ct::profiling {
+
+struct AllocationCounters {
+  std::size_t allocations = 0;
+  std::size_t deallocations = 0;
+  std::size_t allocated_bytes = 0;
+  std::size_t deallocated_bytes = 0;
+  // The maximum number of bytes, which were allocated and not yet deallocated at the same time.
+  std::size_t peak_live_bytes = 0;
+};
+
+// Counters of all the allocations and deallocations made by the current thread since it was started.
+// Memory allocated by one thread and deallocated by another is counted by each of them separately.
+AllocationCounters threadAllocationCounters();
+
+// Counts allocations made by the current thread while the scope is alive.
+// Scopes may be nested, but must be destroyed in the reverse order of creation and by the same thread.
+// When destroyed, the scope adds its counters to the statistics of its call site.
+class AllocationScope {
+public:
+  explicit AllocationScope(std::source_location location = std::source_location::current());
+
+  AllocationScope(const AllocationScope&) = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+
+  ~AllocationScope();
+
+  AllocationCounters counters() const;
+
+  const std::source_location& location() const;
+
+private:
+  std::source_location site;
+  AllocationCounters start;
+  std::ptrdiff_t start_live_bytes;
+  std::ptrdiff_t outer_peak_live_bytes;
+};
+
+struct AllocationSiteStats {
+  const char* file;
+  unsigned line;
+  const char* function;
+  std::size_t scopes;
+  // Sums of the counters of all the scopes, except `peak_live_bytes`, which is their maximum.
+  AllocationCounters counters;
+};
+
+// Statistics of all the call sites of finished scopes, from all the threads.
+std::vector<AllocationSiteStats> allocationSiteStats();
+
+void resetAllocationSiteStats();
+
+struct AllocationBudgetViolation {
+  std::size_t budget;
+  AllocationCounters counters;
+  std::source_location location;
+};
+
+using AllocationBudgetHandler = void (*)(const AllocationBudgetViolation& violation);
+
+// Sets the function, which is called when a budget is exceeded, and returns the previous one.
+// The default handler prints the violation to stderr and aborts.
+AllocationBudgetHandler setAllocationBudgetHandler(AllocationBudgetHandler handler);
+
+// Asserts, that the current thread makes at most `max_allocations` allocations while the budget is alive.
+// The check is made on destruction, so the violation is reported at the call site of the budget.
+class ScopedAllocationBudget {
+public:
+  explicit ScopedAllocationBudget(
+      std::size_t max_allocations, std::source_location location = std::source_location::current()
+  );
+
+  ScopedAllocationBudget(const ScopedAllocationBudget&) = delete;
+  ScopedAllocationBudget& operator=(const ScopedAllocationBudget&) = delete;
+
+  ~ScopedAllocationBudget();
+
+  AllocationCounters counters() const;
+
+private:
+  std::size_t max_allocations;
+  AllocationScope scope;
+};
+
+} // namespace ct::profiling
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+
+namespace ct {
+
+// Same as `ListPtr`, but owners of the same object may be copied, assigned and destroyed concurrently
+// from different threads. Like `std::shared_ptr`, a single `AtomicListPtr` instance must not be modified
+// concurrently with any other access to it.
+template <typename T, typename Deleter = std::default_delete<T>>
+class AtomicListPtr {
+public:
+  AtomicListPtr() noexcept;
+
+  ~AtomicListPtr();
+
+  AtomicListPtr(std::nullptr_t) noexcept;
+
+  explicit AtomicListPtr(T* ptr) noexcept;
+
+  AtomicListPtr(T* ptr, Deleter deleter);
+
+  AtomicListPtr(const AtomicListPtr& other) noexcept;
+
+  AtomicListPtr(AtomicListPtr&& other) noexcept;
+
+  template <typename Y, typename D>
+  AtomicListPtr(const AtomicListPtr<Y, D>& other) noexcept;
+
+  template <typename Y, typename D>
+  AtomicListPtr(AtomicListPtr<Y, D>&& other) noexcept;
+
+  AtomicListPtr& operator=(const AtomicListPtr& other) noexcept;
+
+  AtomicListPtr& operator=(AtomicListPtr&& other) noexcept;
+
+  template <typename Y, typename D>
+  AtomicListPtr& operator=(const AtomicListPtr<Y, D>& other) noexcept;
+
+  template <typename Y, typename D>
+  AtomicListPtr& operator=(AtomicListPtr<Y, D>&& other) noexcept;
+
+  T* get() const noexcept;
+
+  explicit operator bool() const noexcept;
+
+  T& operator*() const noexcept;
+
+  T* operator->() const noexcept;
+
+  std::size_t useCount() const noexcept;
+
+  bool unique() const noexcept;
+
+  void reset() noexcept;
+
+  void reset(T* new_ptr) noexcept;
+
+  T* release() noexcept;
+
+  friend bool operator==(const AtomicListPtr& lhs, const AtomicListPtr& rhs) noexcept;
+
+  friend bool operator!=(const AtomicListPtr& lhs, const AtomicListPtr& rhs) noexcept;
+};
+
+template <typename T, typename... Args>
+AtomicListPtr<T> makeAtomicListPtr(Args&&... args);
+
+} // namespace ct
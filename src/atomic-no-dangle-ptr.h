@@ -0,0 +1,59 @@
+#pragma once
+
+namespace ct {
+
+// Non-dangling pointer, whose object may be destroyed by one thread while its copies are used by others.
+// The object is accessed only through a `Pin`, which keeps it alive: `destroy()` makes all the copies null at once,
+// but the object itself is deleted when the last pin of it is released. Like `std::shared_ptr`,
+// a single `AtomicNoDanglePtr` instance must not be modified concurrently with any other access to it.
+template <typename T>
+class AtomicNoDanglePtr {
+public:
+  class Pin {
+  public:
+    Pin() noexcept;
+
+    Pin(const Pin&) = delete;
+    Pin& operator=(const Pin&) = delete;
+
+    Pin(Pin&& other) noexcept;
+
+    Pin& operator=(Pin&& other) noexcept;
+
+    ~Pin();
+
+    T* get() const noexcept;
+
+    T& operator*() const noexcept;
+
+    T* operator->() const noexcept;
+
+    explicit operator bool() const noexcept;
+  };
+
+  AtomicNoDanglePtr() noexcept;
+
+  ~AtomicNoDanglePtr();
+
+  explicit AtomicNoDanglePtr(T* ptr);
+
+  AtomicNoDanglePtr(const AtomicNoDanglePtr& other) noexcept;
+
+  AtomicNoDanglePtr(AtomicNoDanglePtr&& other) noexcept;
+
+  AtomicNoDanglePtr& operator=(const AtomicNoDanglePtr& other) noexcept;
+
+  AtomicNoDanglePtr& operator=(AtomicNoDanglePtr&& other) noexcept;
+
+  // Returns a null pin if the object has already been destroyed.
+  Pin pin() const noexcept;
+
+  // Makes every copy of this pointer null and deletes the object once it is not pinned.
+  // Does nothing if the object has already been destroyed.
+  void destroy() noexcept;
+
+  // The result may be outdated as soon as it is returned, use `pin()` to access the object.
+  explicit operator bool() const noexcept;
+};
+
+} // namespace ct
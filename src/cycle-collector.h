@@ -0,0 +1,71 @@
+#pragma once
+
+#include "list-ptr.h"
+
+#include <cstddef>
+
+namespace ct {
+
+// Visitor, to which a tracked object reports the `ListPtr`s it holds, wherever they are stored:
+// in its own fields, in containers or in other memory it owns.
+class CycleTracer {
+public:
+  CycleTracer(const CycleTracer&) = delete;
+  CycleTracer& operator=(const CycleTracer&) = delete;
+
+  template <typename T, typename D, typename Links>
+  void operator()(ListPtr<T, D, Links>& edge);
+};
+
+// Type, which may be tracked by `CycleCollector`: `object.trace(tracer)` must report every `ListPtr`
+// held by the object, through which it may reach other tracked objects. The collector may reset the reported
+// pointers of garbage objects to break their cycles, so `trace` takes the object by non-const reference.
+template <typename T>
+concept CycleTraceable = requires(T& object, CycleTracer& tracer) { object.trace(tracer); };
+
+// Opt-in collector of reference cycles among objects owned by `ListPtr`s, e.g. parent/child back-references.
+// A pass counts the references to every tracked object, which are reported by `trace` of other tracked objects,
+// as internal, and the rest of its `useCount()` as external. Tracked objects with external owners are roots:
+// they and everything reachable from them through traced pointers are kept, and the other tracked objects are freed.
+// Since only `useCount()` and the traced pointers are used, and owners are never enumerated, every link policy
+// is supported, including `HybridLinked` groups after their promotion.
+// The collector observes tracked objects like `ListWeakPtr`: it does not keep them alive,
+// and objects, which are destroyed as usual, are dropped from it.
+class CycleCollector {
+public:
+  CycleCollector();
+
+  CycleCollector(const CycleCollector&) = delete;
+  CycleCollector& operator=(const CycleCollector&) = delete;
+
+  ~CycleCollector();
+
+  // Makes the object of `ptr` a candidate for collection, does nothing if `ptr` is null or already tracked.
+  template <CycleTraceable T, typename D, typename Links>
+  void track(const ListPtr<T, D, Links>& ptr);
+
+  // Runs a whole pass and returns the number of freed objects.
+  std::size_t collect();
+
+  // Runs a pass incrementally: traces at most `budget` objects per call and returns `true` once the pass is complete.
+  // Pointers may be changed between the steps: before freeing anything, the pass checks that the use counts
+  // and traced pointers of the garbage have not changed since it was traced, and keeps the objects otherwise.
+  bool collectStep(std::size_t budget);
+
+  // The number of objects freed by the last completed pass.
+  std::size_t lastCollected() const noexcept;
+
+  // The number of tracked objects, which may include destroyed ones until the next pass.
+  std::size_t tracked() const noexcept;
+};
+
+// The process-wide collector.
+CycleCollector& defaultCycleCollector();
+
+template <CycleTraceable T, typename D, typename Links>
+void trackCycles(const ListPtr<T, D, Links>& ptr);
+
+// Runs a whole pass of the process-wide collector and returns the number of freed objects.
+std::size_t collectCycles();
+
+} // namespace ct
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace ct {
+
+// Bounded lock-free queue of objects, whose destruction is deferred: objects may be pushed from any thread,
+// and are destroyed in batches by `drain()`, e.g. by a background reclaimer thread or between requests.
+// The buffer is allocated once by the constructor, so pushing and draining never allocate.
+class DeferredQueue {
+public:
+  explicit DeferredQueue(std::size_t capacity = 4096);
+
+  DeferredQueue(const DeferredQueue&) = delete;
+  DeferredQueue& operator=(const DeferredQueue&) = delete;
+
+  // Destroys all the queued objects.
+  ~DeferredQueue();
+
+  // Queues `destroy(object)`. If the queue is full, calls it immediately instead, so no object is ever lost.
+  void push(void* object, void (*destroy)(void*)) noexcept;
+
+  // Destroys all the queued objects in the order they were pushed and returns their number.
+  // Only one thread may drain the queue at a time, but others may push to it concurrently.
+  std::size_t drain() noexcept;
+
+  // The result may be outdated as soon as it is returned, if other threads use the queue.
+  std::size_t size() const noexcept;
+
+  std::size_t capacity() const noexcept;
+};
+
+// The queue of the calling thread, which is drained when the thread exits.
+// It is created on the first call, which allocates its buffer, so call it when the thread starts.
+DeferredQueue& threadDeferredQueue();
+
+// The queue of the calling thread, or null if `threadDeferredQueue()` has not created it yet.
+DeferredQueue* existingThreadDeferredQueue() noexcept;
+
+// Drains the queue of the calling thread, if it has one, and returns the number of destroyed objects.
+std::size_t drainDeferred() noexcept;
+
+// Deleter for `ListPtr`, which defers the destruction of the object instead of running it on the hot path:
+// the object is pushed to the given queue, or, by default, to the queue of the thread, which releases the last owner.
+// The default deleter never creates that queue, since it is called by the destructor of a `ListPtr`, which must not
+// allocate: on a thread, which has not called `threadDeferredQueue()`, the object is destroyed immediately.
+template <typename T>
+class DeferredDeleter {
+public:
+  DeferredDeleter();
+
+  explicit DeferredDeleter(DeferredQueue& queue) noexcept;
+
+  template <typename Y>
+    requires std::is_convertible_v<Y*, T*>
+  DeferredDeleter(const DeferredDeleter<Y>& other) noexcept;
+
+  void operator()(T* object) const noexcept;
+};
+
+} // namespace ct
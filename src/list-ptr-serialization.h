@@ -0,0 +1,93 @@
+#pragma once
+
+#include "list-ptr.h"
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <type_traits>
+
+namespace ct {
+
+class OutputArchive;
+class InputArchive;
+
+// Type, which saves and loads its own fields, it is loaded into a default-constructed instance.
+template <typename T>
+concept SelfSerializable =
+    std::is_default_constructible_v<T> && requires(const T& object, T& target, OutputArchive& out, InputArchive& in) {
+      object.save(out);
+      target.load(in);
+    };
+
+// Arithmetic and enumeration values, and arrays of them, are written as their bytes. Other trivially copyable types,
+// pointers included, are not: they may hold addresses, which mean nothing when read back.
+template <typename T>
+concept BytewiseSerializable =
+    std::is_arithmetic_v<std::remove_all_extents_t<T>> || std::is_enum_v<std::remove_all_extents_t<T>>;
+
+template <typename T>
+concept Serializable = BytewiseSerializable<T> || SelfSerializable<T>;
+
+// Type of objects, which may be written through a `ListPtr`. Polymorphic types are rejected, since only the `T` part
+// of an object of a derived type would be written. Arrays are rejected as well, since `ListPtr<T[]>` does not know
+// the number of its elements.
+template <typename T>
+concept SerializableObject = Serializable<T> && !std::is_polymorphic_v<T> && !std::is_array_v<T>;
+
+// Writes values and graphs of objects reachable through `ListPtr`s to a compact binary stream.
+// Every object is written once, when the first pointer to it is met; later pointers to it are written as references.
+// Objects are identified by `get()`, so aliasing is not preserved: an aliasing pointer is written as a pointer
+// to a separate object, which is equal to the one it points to, and shares nothing with its owner after reading.
+class OutputArchive {
+public:
+  explicit OutputArchive(std::ostream& out);
+
+  OutputArchive(const OutputArchive&) = delete;
+  OutputArchive& operator=(const OutputArchive&) = delete;
+
+  ~OutputArchive();
+
+  template <Serializable T>
+  void write(const T& value);
+
+  template <SerializableObject T, typename D, typename Links>
+  void write(const ListPtr<T, D, Links>& ptr);
+};
+
+// Reads what `OutputArchive` has written, either from a stream or from memory, e.g. from a memory-mapped file.
+// Pointers, which shared an object when written, share one object after reading, and their rings are rebuilt,
+// so `useCount()` of a read pointer counts the read pointers to the object.
+// The object is registered before its fields are loaded, so a graph may refer to an object from its own fields.
+class InputArchive {
+public:
+  explicit InputArchive(std::istream& in);
+
+  explicit InputArchive(std::span<const std::byte> bytes);
+
+  InputArchive(const InputArchive&) = delete;
+  InputArchive& operator=(const InputArchive&) = delete;
+
+  ~InputArchive();
+
+  template <Serializable T>
+  void read(T& value);
+
+  // Read objects are created by `new`, so only pointers with the default deleter may be read.
+  template <SerializableObject T, typename Links>
+  void read(ListPtr<T, typename ListPtrDefaultDeleter<T>::type, Links>& ptr);
+};
+
+// Writes the graph of objects reachable from `root`.
+template <SerializableObject T, typename D, typename Links>
+void serialize(std::ostream& out, const ListPtr<T, D, Links>& root);
+
+// Reads a graph written by `serialize` and returns its root. Throws `std::runtime_error` if the data is malformed.
+template <SerializableObject T>
+ListPtr<T> deserialize(std::istream& in);
+
+template <SerializableObject T>
+ListPtr<T> deserialize(std::span<const std::byte> bytes);
+
+} // namespace ct
@@ -1,64 +1,271 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <type_traits>
+
+#ifdef CT_LIST_PTR_DIAGNOSTICS
+#include <array>
+#include <iosfwd>
+#endif
 
 namespace ct {
 
-template <typename T, typename Deleter = std::default_delete<T>>
+// Owners are linked into a doubly linked list: removing an owner takes O(1),
+// but every owner stores two links.
+struct DoublyLinked {};
+
+// Owners are linked into a singly linked ring: every owner stores one link,
+// but removing an owner takes O(n), since it has to find its predecessor.
+struct SinglyLinked {};
+
+// Owners are linked into a doubly linked list while the group has at most `Threshold` owners.
+// When it grows beyond that, the group is promoted to a counted control block, which is allocated once:
+// from then on `useCount()` takes O(1) and removing an owner touches only the block, not its neighbours.
+// So a pointer allocates only when its group exceeds `Threshold` owners. Owners of a promoted group are no longer
+// linked to each other, so operations, which walk the owners (`resetAll()` and the ring diagnostics),
+// are not available for this policy.
+template <std::size_t Threshold = 8>
+struct HybridLinked {
+  static_assert(Threshold >= 1, "a group must be linked at least while it has a single owner");
+
+  static constexpr std::size_t threshold = Threshold;
+};
+
+template <typename Links>
+inline constexpr bool is_hybrid_linked_v = false;
+
+template <std::size_t Threshold>
+inline constexpr bool is_hybrid_linked_v<HybridLinked<Threshold>> = true;
+
+// The default deleter of `ListPtr<T>`: `delete` for objects and `delete[]` for arrays, bounded ones included.
+template <typename T>
+struct ListPtrDefaultDeleter {
+  using type = std::default_delete<T>;
+};
+
+template <typename T>
+  requires std::is_array_v<T>
+struct ListPtrDefaultDeleter<T> {
+  using type = std::default_delete<std::remove_extent_t<T>[]>;
+};
+
+// Whether `ListPtr<T>` may take ownership of a `Y*`. As for `std::shared_ptr<T[]>`, an array is owned
+// only through a pointer to its own element type, up to cv-qualification, since `delete[]` through
+// a pointer to a base is undefined.
+template <typename Y, typename T>
+concept ListPtrOwnable = (!std::is_array_v<T> && std::is_convertible_v<Y*, T*>) ||
+                         (std::is_unbounded_array_v<T> && std::is_convertible_v<Y (*)[], T*>) ||
+                         (std::is_bounded_array_v<T> && std::is_convertible_v<Y (*)[std::extent_v<T>], T*>);
+
+// Whether an owner with the deleter `Deleter` may join the group of an owner with the deleter `D`.
+// A stateless deleter is not stored by owners of other types: it is default-constructed when the object is deleted.
+// A stateful one, e.g. `AllocatorDeleter` with a `std::pmr::polymorphic_allocator`, has nowhere to be kept
+// but in the deleter of the new owner, so it has to be convertible to it.
+template <typename D, typename Deleter>
+concept ListPtrDeleterConvertible =
+    std::is_convertible_v<D, Deleter> || (std::is_empty_v<D> && std::is_default_constructible_v<D>);
+
+// Construction, copying, moving, resetting and destruction are usable in constant evaluation.
+// As with any constexpr allocation, every object must be deleted before the evaluation ends,
+// so a `ListPtr` cannot be stored in a `constexpr` variable unless it is null.
+template <typename T, typename Deleter = typename ListPtrDefaultDeleter<T>::type, typename Links = DoublyLinked>
 class ListPtr {
 public:
-  ListPtr();
+  // `T` may be an array type `U[]` or `U[N]`, in which case the pointer owns an array of `U`,
+  // which is deleted by `delete[]` with the default deleter.
+  using element_type = std::remove_extent_t<T>;
 
-  ~ListPtr();
+  constexpr ListPtr() noexcept;
 
-  ListPtr(std::nullptr_t);
+  constexpr ~ListPtr();
 
-  explicit ListPtr(T* ptr);
+  constexpr ListPtr(std::nullptr_t) noexcept;
 
-  ListPtr(T* ptr, Deleter deleter);
+  template <typename Y>
+    requires ListPtrOwnable<Y, T>
+  constexpr explicit ListPtr(Y* ptr) noexcept;
 
-  ListPtr(const ListPtr& other);
+  template <typename Y>
+    requires ListPtrOwnable<Y, T>
+  constexpr ListPtr(Y* ptr, Deleter deleter);
 
-  ListPtr(ListPtr&& other);
+  // Copies are not `noexcept`, since copying into a `HybridLinked` group may promote it, which allocates.
+  constexpr ListPtr(const ListPtr& other);
+
+  constexpr ListPtr(ListPtr&& other) noexcept;
+
+  template <typename Y, typename D>
+    requires std::is_convertible_v<Y*, T*> && ListPtrDeleterConvertible<D, Deleter>
+  constexpr ListPtr(const ListPtr<Y, D, Links>& other);
 
   template <typename Y, typename D>
-  ListPtr(const ListPtr<Y, D>& other);
+    requires std::is_convertible_v<Y*, T*> && ListPtrDeleterConvertible<D, Deleter>
+  constexpr ListPtr(ListPtr<Y, D, Links>&& other) noexcept;
 
   template <typename Y, typename D>
-  ListPtr(ListPtr<Y, D>&& other);
+    requires ListPtrDeleterConvertible<D, Deleter>
+  constexpr ListPtr(const ListPtr<Y, D, Links>& owner, element_type* alias);
 
-  ListPtr& operator=(const ListPtr& other);
+  template <typename Y, typename D>
+    requires ListPtrDeleterConvertible<D, Deleter>
+  constexpr ListPtr(ListPtr<Y, D, Links>&& owner, element_type* alias) noexcept;
 
-  ListPtr& operator=(ListPtr&& other);
+  constexpr ListPtr& operator=(const ListPtr& other);
+
+  constexpr ListPtr& operator=(ListPtr&& other) noexcept;
 
   template <typename Y, typename D>
-  ListPtr& operator=(const ListPtr<Y, D>& other);
+    requires std::is_convertible_v<Y*, T*> && ListPtrDeleterConvertible<D, Deleter>
+  constexpr ListPtr& operator=(const ListPtr<Y, D, Links>& other);
 
   template <typename Y, typename D>
-  ListPtr& operator=(ListPtr<Y, D>&& other);
+    requires std::is_convertible_v<Y*, T*> && ListPtrDeleterConvertible<D, Deleter>
+  constexpr ListPtr& operator=(ListPtr<Y, D, Links>&& other) noexcept;
+
+  constexpr element_type* get() const noexcept;
+
+  constexpr explicit operator bool() const noexcept;
 
-  T* get() const;
+  constexpr element_type& operator*() const noexcept
+    requires (!std::is_array_v<T>);
 
-  explicit operator bool() const;
+  constexpr element_type* operator->() const noexcept
+    requires (!std::is_array_v<T>);
 
-  T& operator*() const;
+  constexpr element_type& operator[](std::ptrdiff_t i) const noexcept
+    requires std::is_array_v<T>;
 
-  T* operator->() const;
+  constexpr std::size_t useCount() const noexcept;
 
-  std::size_t useCount() const;
+  // Takes O(1) if the object has no `ListWeakPtr` observers, and O(observers) otherwise,
+  // since observers are linked between owners and have to be skipped.
+  constexpr bool unique() const noexcept;
 
-  void reset();
+  constexpr void reset() noexcept;
 
-  void reset(T* new_ptr);
+  template <typename Y>
+    requires ListPtrOwnable<Y, T>
+  constexpr void reset(Y* new_ptr) noexcept;
 
-  T* release();
+  constexpr element_type* release() noexcept;
 
-  friend bool operator==(const ListPtr& lhs, const ListPtr& rhs);
+  // Resets every owner in the list of this pointer, destroying the object once.
+  void resetAll() noexcept
+    requires (!is_hybrid_linked_v<Links>);
 
-  friend bool operator!=(const ListPtr& lhs, const ListPtr& rhs);
+#ifdef CT_LIST_PTR_DIAGNOSTICS
+  // Checks that the links of the ring of this pointer are consistent
+  // and that all the owners in it share the same object.
+  bool validateRing() const noexcept
+    requires (!is_hybrid_linked_v<Links>);
+
+  // Writes the object and the addresses of all the owners in the ring of this pointer to `out`.
+  void dumpOwners(std::ostream& out) const
+    requires (!is_hybrid_linked_v<Links>);
+#endif
+
+  friend constexpr bool operator==(const ListPtr& lhs, const ListPtr& rhs) noexcept;
+
+  friend constexpr bool operator!=(const ListPtr& lhs, const ListPtr& rhs) noexcept;
 };
 
+// Non-owning observer, which is linked into the same list as owners, but is not counted in `useCount()`.
+// `lock()` returns an owner with the default deleter, so only groups, which it may join, can be observed.
+template <typename T, typename Links = DoublyLinked>
+class ListWeakPtr {
+public:
+  ListWeakPtr() noexcept;
+
+  ~ListWeakPtr();
+
+  template <typename Y, typename D>
+    requires std::is_convertible_v<Y*, T*> && ListPtrDeleterConvertible<D, typename ListPtrDefaultDeleter<T>::type>
+  ListWeakPtr(const ListPtr<Y, D, Links>& owner) noexcept;
+
+  ListWeakPtr(const ListWeakPtr& other) noexcept;
+
+  ListWeakPtr(ListWeakPtr&& other) noexcept;
+
+  template <typename Y>
+    requires std::is_convertible_v<Y*, T*>
+  ListWeakPtr(const ListWeakPtr<Y, Links>& other) noexcept;
+
+  ListWeakPtr& operator=(const ListWeakPtr& other) noexcept;
+
+  ListWeakPtr& operator=(ListWeakPtr&& other) noexcept;
+
+  template <typename Y, typename D>
+    requires std::is_convertible_v<Y*, T*> && ListPtrDeleterConvertible<D, typename ListPtrDefaultDeleter<T>::type>
+  ListWeakPtr& operator=(const ListPtr<Y, D, Links>& owner) noexcept;
+
+  std::size_t useCount() const noexcept;
+
+  bool expired() const noexcept;
+
+  ListPtr<T, typename ListPtrDefaultDeleter<T>::type, Links> lock() const;
+
+  void reset() noexcept;
+};
+
+#ifdef CT_LIST_PTR_DIAGNOSTICS
+// Process-wide counters of all the `ListPtr`s, which are collected only when `CT_LIST_PTR_DIAGNOSTICS` is defined.
+// Counting a ring would make copies O(n), so ring sizes are recorded only when a ring is traversed anyway:
+// by `useCount()`, `resetAll()`, `validateRing()` and unlinking from a singly linked ring.
+struct ListPtrStats {
+  static constexpr std::size_t buckets_count = 32;
+
+  // `ring_sizes[i]` is the number of traversed rings of [2^i, 2^(i+1)) owners.
+  std::array<std::size_t, buckets_count> ring_sizes;
+  std::size_t max_ring_size;
+  std::size_t unlinks;
+  // The total number of links followed to unlink owners, it equals `unlinks` for `DoublyLinked` rings.
+  std::size_t unlink_steps;
+};
+
+// The counters are updated by relaxed atomic operations, so different `ListPtr`s may be used from different threads.
+// The snapshot is not consistent across fields while other threads update the counters.
+ListPtrStats listPtrStats() noexcept;
+
+void resetListPtrStats() noexcept;
+#endif
+
+// Makes exactly one allocation of the size of the object: owners keep everything they need in themselves,
+// so there is no bookkeeping to place next to it. The same holds in constant evaluation.
 template <typename T, typename... Args>
-ListPtr<T> makeListPtr(Args&&... args);
+  requires (!std::is_array_v<T>)
+constexpr ListPtr<T> makeListPtr(Args&&... args);
+
+// Allocates `n` value-initialized elements in a single block.
+template <typename T>
+  requires std::is_unbounded_array_v<T>
+constexpr ListPtr<T> makeListPtr(std::size_t n);
+
+template <typename T>
+  requires std::is_bounded_array_v<T>
+constexpr ListPtr<T> makeListPtr();
+
+template <typename T>
+ListPtr<T> makeListPtrForOverwrite();
+
+// Deleter of the objects created by `allocateListPtr`: destroys the object and returns its memory
+// to the copy of the allocator, which is stored in the deleter, not in the block of the object.
+// So a stateless allocator takes no space in `ListPtr`, and a stateful one takes as much as itself.
+// It is not default-constructible, so owners with other deleters cannot join its group.
+template <typename Alloc>
+class AllocatorDeleter {
+public:
+  using allocator_type = Alloc;
+
+  explicit AllocatorDeleter(const Alloc& alloc) noexcept;
+
+  void operator()(typename std::allocator_traits<Alloc>::value_type* object) const noexcept;
+};
+
+// Allocates the object by a copy of `alloc`, rebound to `T`. As with `makeListPtr`, the block is exactly
+// the size of the object, and the allocator is kept by the deleter of the returned pointer.
+template <typename T, typename Alloc, typename... Args>
+ListPtr<T, AllocatorDeleter<typename std::allocator_traits<Alloc>::template rebind_alloc<T>>>
+allocateListPtr(const Alloc& alloc, Args&&... args);
 
 } // namespace ct
@@ -1,29 +1,104 @@
 #pragma once
 
+#include <cstddef>
+
+namespace ct {
+
+// Base class, which makes `NoDanglePtr<T>` intrusive for `T` derived from it: the head of the list of pointers
+// to the object lives inside the object, so creating, copying and invalidating the pointers never allocates.
+// Destroying the object, by `delete` or otherwise, makes every pointer to it null.
+// Only intrusive pointers are usable in constant evaluation, since the others keep track of objects outside of them.
+class NoDangleTarget {
+protected:
+  constexpr NoDangleTarget() noexcept;
+
+  // A copy is a new object, so it is not observed by the pointers to the original one.
+  constexpr NoDangleTarget(const NoDangleTarget& other) noexcept;
+
+  // Keeps the pointers to this object, the pointers to `other` are not affected.
+  constexpr NoDangleTarget& operator=(const NoDangleTarget& other) noexcept;
+
+  constexpr ~NoDangleTarget();
+};
+
+} // namespace ct
+
 template <typename T>
 class NoDanglePtr {
 public:
-  NoDanglePtr();
+  // Scoped access to the object: the pointer is checked once, when the pin is taken,
+  // and the pin then gives unchecked access to the object. Deleting the object while it is pinned
+  // is a bug, which is reported by an assertion in debug builds.
+  class Pin {
+  public:
+    Pin() noexcept;
+
+    Pin(const Pin&) = delete;
+    Pin& operator=(const Pin&) = delete;
+
+    Pin(Pin&& other) noexcept;
+
+    Pin& operator=(Pin&& other) noexcept;
+
+    ~Pin();
+
+    T* get() const noexcept;
 
-  ~NoDanglePtr();
+    T& operator*() const noexcept;
 
-  explicit NoDanglePtr(T* ptr);
+    T* operator->() const noexcept;
 
-  NoDanglePtr(const NoDanglePtr& other);
+    explicit operator bool() const noexcept;
+  };
 
-  NoDanglePtr(NoDanglePtr&& other);
+  constexpr NoDanglePtr();
 
-  NoDanglePtr& operator=(const NoDanglePtr& other);
+  constexpr ~NoDanglePtr();
 
-  NoDanglePtr& operator=(NoDanglePtr&& other);
+  constexpr explicit NoDanglePtr(T* ptr);
+
+  constexpr NoDanglePtr(const NoDanglePtr& other);
+
+  constexpr NoDanglePtr(NoDanglePtr&& other);
+
+  constexpr NoDanglePtr& operator=(const NoDanglePtr& other);
+
+  constexpr NoDanglePtr& operator=(NoDanglePtr&& other);
+
+  constexpr T* get() const;
+
+  constexpr operator T*() const;
+
+  constexpr T& operator*() const;
+
+  constexpr T* operator->() const;
+
+  constexpr explicit operator bool() const;
+
+  // Returns a null pin if the object has already been deleted.
+  Pin pin() const noexcept;
+};
+
+// Owner of a batch of objects tracked by `NoDanglePtr`, which are destroyed all at once.
+// `reset()` takes O(objects) regardless of how many pointers observe them: instead of detaching
+// every pointer one by one, the arena invalidates the whole batch, so all the pointers to its objects become null.
+// Objects of an arena must not be deleted by `delete`, and must not be pinned when the arena is reset.
+class NoDangleArena {
+public:
+  NoDangleArena() noexcept;
 
-  T* get() const;
+  NoDangleArena(const NoDangleArena&) = delete;
+  NoDangleArena& operator=(const NoDangleArena&) = delete;
 
-  operator T*() const;
+  // Destroys all the objects of the arena, as `reset()`.
+  ~NoDangleArena();
 
-  T& operator*() const;
+  template <typename T, typename... Args>
+  NoDanglePtr<T> make(Args&&... args);
 
-  T* operator->() const;
+  // Destroys all the objects of the arena, the arena may be reused afterwards.
+  void reset() noexcept;
 
-  explicit operator bool() const;
+  // The number of objects, which are currently owned by the arena.
+  std::size_t size() const noexcept;
 };
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+namespace ct {
+
+// Non-dangling pointer to an object stored in a per-type slot table.
+// The pointer is an {index, generation} pair: destroying the object bumps the generation of its slot,
+// which invalidates all the copies at once, and checking a pointer for validity is a single comparison.
+// Objects are created by `makeSlotNoDanglePtr` and destroyed by `destroy()`, never by `delete`.
+template <typename T>
+class SlotNoDanglePtr {
+public:
+  SlotNoDanglePtr() noexcept;
+
+  SlotNoDanglePtr(std::nullptr_t) noexcept;
+
+  SlotNoDanglePtr(const SlotNoDanglePtr& other) = default;
+
+  SlotNoDanglePtr& operator=(const SlotNoDanglePtr& other) = default;
+
+  T* get() const noexcept;
+
+  T& operator*() const noexcept;
+
+  T* operator->() const noexcept;
+
+  explicit operator bool() const noexcept;
+
+  // Destroys the object and invalidates every copy of this pointer. Does nothing if the pointer is already null.
+  void destroy() const noexcept;
+
+  friend bool operator==(const SlotNoDanglePtr& lhs, const SlotNoDanglePtr& rhs) noexcept;
+
+  friend bool operator!=(const SlotNoDanglePtr& lhs, const SlotNoDanglePtr& rhs) noexcept;
+};
+
+template <typename T, typename... Args>
+SlotNoDanglePtr<T> makeSlotNoDanglePtr(Args&&... args);
+
+} // namespace ct
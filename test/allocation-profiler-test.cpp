@@ -0,0 +1,170 @@
+#include "allocation-profiler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <barrier>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <source_location>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace ct::test {
+
+using namespace profiling;
+
+namespace {
+
+std::vector<AllocationBudgetViolation> violations;
+
+void recordBudgetViolation(const AllocationBudgetViolation& violation) {
+  violations.push_back(violation);
+}
+
+// Keeps the compiler from eliding a pair of allocation and deallocation, which it is allowed to do.
+void* volatile sink = nullptr;
+
+void escape(void* ptr) {
+  sink = ptr;
+}
+
+struct alignas(64) Overaligned {
+  char data[64];
+};
+
+} // namespace
+
+TEST(AllocationProfilerTest, CountsAllocations) {
+  AllocationScope scope;
+  auto* object = new int(42);
+  auto* array = new int[8];
+  escape(object);
+  escape(array);
+  EXPECT_EQ(2, scope.counters().allocations);
+  EXPECT_EQ(sizeof(int) * 9, scope.counters().allocated_bytes);
+  EXPECT_EQ(0, scope.counters().deallocations);
+
+  delete object;
+  delete[] array;
+  EXPECT_EQ(2, scope.counters().deallocations);
+  EXPECT_EQ(sizeof(int) * 9, scope.counters().deallocated_bytes);
+}
+
+TEST(AllocationProfilerTest, OveralignedAllocations) {
+  AllocationScope scope;
+  auto object = std::make_unique<Overaligned>();
+  escape(object.get());
+  EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(object.get()) % alignof(Overaligned));
+  object.reset();
+  EXPECT_EQ(1, scope.counters().allocations);
+  EXPECT_EQ(sizeof(Overaligned), scope.counters().deallocated_bytes);
+}
+
+TEST(AllocationProfilerTest, PeakLiveBytes) {
+  auto outside = std::make_unique<char[]>(1024);
+  escape(outside.get());
+
+  AllocationScope scope;
+  {
+    auto first = std::make_unique<char[]>(100);
+    escape(first.get());
+    auto second = std::make_unique<char[]>(200);
+    escape(second.get());
+  }
+  auto third = std::make_unique<char[]>(50);
+  escape(third.get());
+  EXPECT_EQ(300, scope.counters().peak_live_bytes);
+}
+
+TEST(AllocationProfilerTest, NestedScopes) {
+  AllocationScope outer;
+  auto first = std::make_unique<char[]>(100);
+  escape(first.get());
+  {
+    AllocationScope inner;
+    auto second = std::make_unique<char[]>(10);
+    escape(second.get());
+    EXPECT_EQ(1, inner.counters().allocations);
+    EXPECT_EQ(10, inner.counters().peak_live_bytes);
+  }
+  EXPECT_EQ(2, outer.counters().allocations);
+  EXPECT_EQ(110, outer.counters().peak_live_bytes);
+}
+
+TEST(AllocationProfilerTest, PerThread) {
+  std::size_t child_allocations = 0;
+  std::barrier sync(2);
+  std::thread child([&] {
+    sync.arrive_and_wait();
+    auto before = threadAllocationCounters();
+    auto object = std::make_unique<int>(42);
+    escape(object.get());
+    child_allocations = threadAllocationCounters().allocations - before.allocations;
+    sync.arrive_and_wait();
+  });
+
+  {
+    AllocationScope scope;
+    sync.arrive_and_wait();
+    sync.arrive_and_wait();
+    EXPECT_EQ(0, scope.counters().allocations);
+  }
+  child.join();
+  EXPECT_EQ(1, child_allocations);
+}
+
+TEST(AllocationProfilerTest, PerSite) {
+  resetAllocationSiteStats();
+  std::source_location site;
+  for (int i = 0; i < 3; ++i) {
+    site = std::source_location::current();
+    AllocationScope scope(site);
+    auto object = std::make_unique<int>(i);
+    escape(object.get());
+  }
+
+  auto stats = allocationSiteStats();
+  auto it = std::find_if(stats.begin(), stats.end(), [&](const AllocationSiteStats& s) {
+    return s.line == site.line() && std::string_view(s.file) == site.file_name();
+  });
+  ASSERT_NE(stats.end(), it);
+  EXPECT_EQ(3, it->scopes);
+  EXPECT_EQ(3, it->counters.allocations);
+  EXPECT_EQ(3 * sizeof(int), it->counters.allocated_bytes);
+  EXPECT_EQ(sizeof(int), it->counters.peak_live_bytes);
+}
+
+TEST(AllocationProfilerTest, BudgetKept) {
+  violations.clear();
+  auto previous = setAllocationBudgetHandler(&recordBudgetViolation);
+  {
+    ScopedAllocationBudget budget(1);
+    auto object = std::make_unique<int>(42);
+    escape(object.get());
+  }
+  setAllocationBudgetHandler(previous);
+  EXPECT_TRUE(violations.empty());
+}
+
+TEST(AllocationProfilerTest, BudgetExceeded) {
+  violations.clear();
+  auto previous = setAllocationBudgetHandler(&recordBudgetViolation);
+  std::source_location site;
+  {
+    site = std::source_location::current();
+    ScopedAllocationBudget budget(0, site);
+    auto object = std::make_unique<int>(42);
+    escape(object.get());
+  }
+  setAllocationBudgetHandler(previous);
+
+  ASSERT_EQ(1, violations.size());
+  EXPECT_EQ(0, violations.front().budget);
+  EXPECT_EQ(1, violations.front().counters.allocations);
+  EXPECT_EQ(site.line(), violations.front().location.line());
+}
+
+} // namespace ct::test
@@ -1,52 +1,34 @@
+#include "allocation-profiler.h"
+#include "atomic-list-ptr.h"
+#include "deferred-deleter.h"
 #include "gtest/gtest.h"
 #include "list-ptr.h"
+#include "no-dangle-ptr.h"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <cstdlib>
-#include <new>
+#include <memory_resource>
+#include <optional>
+#include <source_location>
+#include <thread>
 
-static thread_local std::size_t allocations = 0;
-
-void* operator new(std::size_t count) {
-  ++allocations;
-  void* ptr = std::malloc(count);
-  if (!ptr) {
-    throw std::bad_alloc();
-  }
-  return ptr;
-}
-
-void* operator new[](std::size_t count) {
-  return operator new(count);
-}
-
-void* operator new(std::size_t count, const std::nothrow_t&) noexcept {
-  ++allocations;
-  void* ptr = std::malloc(count);
-  return ptr;
-}
-
-void* operator new[](std::size_t count, const std::nothrow_t& token) noexcept {
-  return operator new(count, token);
-}
+namespace ct::test {
 
-void operator delete(void* ptr) noexcept {
-  std::free(ptr);
-}
+using namespace profiling;
 
-void operator delete[](void* ptr) noexcept {
-  operator delete(ptr);
-}
+namespace {
 
-void operator delete(void* ptr, std::size_t) noexcept {
-  operator delete(ptr);
+void reportBudgetViolation(const AllocationBudgetViolation& violation) {
+  ADD_FAILURE_AT(violation.location.file_name(), static_cast<int>(violation.location.line()))
+      << "Allocation budget exceeded: " << violation.counters.allocations << " allocations ("
+      << violation.counters.allocated_bytes << " bytes), at most " << violation.budget << " expected";
 }
 
-void operator delete[](void* ptr, std::size_t) noexcept {
-  operator delete(ptr);
-}
+[[maybe_unused]] const AllocationBudgetHandler previous_budget_handler =
+    setAllocationBudgetHandler(&reportBudgetViolation);
 
-namespace ct::test {
+} // namespace
 
 class A {
 public:
@@ -73,6 +55,18 @@ public:
       : A(v) {}
 };
 
+class Target : public NoDangleTarget {
+public:
+  explicit Target(int value)
+      : value(value) {}
+
+  int value;
+};
+
+struct alignas(64) Overaligned {
+  char data[64];
+};
+
 class AllocationTest : public ::testing::Test {
 public:
   A* data;
@@ -84,23 +78,33 @@ protected:
     data = new A(42);
     more_data = new A(43);
     another_data = new B(44);
-    allocations = 0;
+    scope.emplace(std::source_location::current());
+  }
+
+  std::size_t allocations() const {
+    return scope->counters().allocations;
   }
 
+  std::size_t allocatedBytes() const {
+    return scope->counters().allocated_bytes;
+  }
+
+  std::optional<AllocationScope> scope;
+
   virtual void CleanUp() {}
 };
 
 class NoAllocExpected : public AllocationTest {
 protected:
   void TearDown() override {
-    EXPECT_EQ(allocations, 0);
+    EXPECT_EQ(allocations(), 0);
   }
 };
 
 class AllocOnceExpected : public AllocationTest {
 protected:
   void TearDown() override {
-    EXPECT_EQ(allocations, 1);
+    EXPECT_EQ(allocations(), 1);
   }
 };
 
@@ -149,6 +153,65 @@ TEST_F(NoAllocExpected, ConvertiblePrvalueCtor) {
   ListPtr<A> q = ListPtr<B>(another_data);
 }
 
+TEST_F(NoAllocExpected, AliasingCtor) {
+  ListPtr<B> p(another_data);
+  ListPtr<A> q(p, data);
+  ListPtr<A> r(std::move(p), more_data);
+}
+
+TEST_F(NoAllocExpected, WeakPtr) {
+  Ptr p(data);
+  ListWeakPtr<A> w = p;
+  ListWeakPtr<A> v = w;
+  Ptr q = v.lock();
+  EXPECT_FALSE(w.expired());
+  p.reset();
+  q.reset();
+  EXPECT_TRUE(v.expired());
+}
+
+TEST_F(NoAllocExpected, ResetAll) {
+  Ptr p(data);
+  Ptr q = p;
+  q.resetAll();
+}
+
+using SinglyLinkedPtr = ListPtr<A, std::default_delete<A>, SinglyLinked>;
+
+TEST_F(NoAllocExpected, SinglyLinkedCopyCtor) {
+  SinglyLinkedPtr p(data);
+  SinglyLinkedPtr q = p;
+  SinglyLinkedPtr r = q;
+}
+
+TEST_F(NoAllocExpected, SinglyLinkedAssign) {
+  SinglyLinkedPtr p(data);
+  SinglyLinkedPtr q(more_data);
+  q = p;
+  SinglyLinkedPtr r;
+  r = std::move(q);
+}
+
+using HybridPtr = ListPtr<A, std::default_delete<A>, HybridLinked<4>>;
+
+TEST_F(NoAllocExpected, HybridBelowThreshold) {
+  HybridPtr p(data);
+  std::array<HybridPtr, 3> owners;
+  for (auto& owner : owners) {
+    owner = p;
+  }
+  EXPECT_EQ(p.useCount(), 4);
+}
+
+TEST_F(AllocOnceExpected, HybridPromotion) {
+  HybridPtr p(data);
+  std::array<HybridPtr, 64> owners;
+  for (auto& owner : owners) {
+    owner = p;
+  }
+  EXPECT_EQ(p.useCount(), 65);
+}
+
 TEST_F(NoAllocExpected, CopyAssign) {
   Ptr p(data);
   Ptr q;
@@ -184,6 +247,7 @@ TEST_F(NoAllocExpected, ConstOperations) {
   EXPECT_TRUE(static_cast<bool>(p));
   EXPECT_EQ(p.operator->(), data);
   EXPECT_EQ(p.useCount(), 1);
+  EXPECT_TRUE(p.unique());
 }
 
 TEST_F(NoAllocExpected, Reset) {
@@ -211,4 +275,260 @@ TEST_F(AllocOnceExpected, Make) {
   auto p = makeListPtr<int>(42);
 }
 
+TEST_F(AllocOnceExpected, MakeAllocatesOnlyObject) {
+  auto p = makeListPtr<A>(42);
+  EXPECT_EQ(allocatedBytes(), sizeof(A));
+}
+
+TEST_F(AllocOnceExpected, MakeOveraligned) {
+  auto p = makeListPtr<Overaligned>();
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p.get()) % alignof(Overaligned), 0);
+  EXPECT_EQ(allocatedBytes(), sizeof(Overaligned));
+}
+
+TEST_F(AllocOnceExpected, MakeForOverwrite) {
+  auto p = makeListPtrForOverwrite<Overaligned>();
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p.get()) % alignof(Overaligned), 0);
+  EXPECT_EQ(allocatedBytes(), sizeof(Overaligned));
+}
+
+TEST_F(AllocOnceExpected, MakeUnboundedArray) {
+  auto p = makeListPtr<int[]>(16);
+  auto q = p;
+  EXPECT_EQ(allocatedBytes(), 16 * sizeof(int));
+}
+
+TEST_F(AllocOnceExpected, MakeBoundedArray) {
+  auto p = makeListPtr<Overaligned[2]>();
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p.get()) % alignof(Overaligned), 0);
+  EXPECT_EQ(allocatedBytes(), 2 * sizeof(Overaligned));
+}
+
+TEST_F(NoAllocExpected, AllocateFromArena) {
+  std::array<std::byte, 256> buffer;
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+  auto p = allocateListPtr<A>(std::pmr::polymorphic_allocator<A>(&arena), 42);
+  auto q = p;
+}
+
+using AtomicPtr = AtomicListPtr<A>;
+
+TEST_F(NoAllocExpected, AtomicPtrCtor) {
+  AtomicPtr p(data);
+}
+
+TEST_F(NoAllocExpected, AtomicCopyCtor) {
+  AtomicPtr p(data);
+  AtomicPtr q = p;
+}
+
+TEST_F(NoAllocExpected, AtomicMoveCtor) {
+  AtomicPtr p(data);
+  AtomicPtr q = std::move(p);
+}
+
+TEST_F(NoAllocExpected, AtomicConvertibleCtor) {
+  AtomicListPtr<B> p(another_data);
+  AtomicListPtr<A> q = p;
+}
+
+TEST_F(NoAllocExpected, AtomicCopyAssign) {
+  AtomicPtr p(data);
+  AtomicPtr q;
+  q = p;
+}
+
+TEST_F(NoAllocExpected, AtomicMoveAssign) {
+  AtomicPtr p(data);
+  AtomicPtr q;
+  q = std::move(p);
+}
+
+TEST_F(NoAllocExpected, AtomicConstOperations) {
+  AtomicPtr p(data);
+  EXPECT_EQ(p.get(), data);
+  EXPECT_TRUE(static_cast<bool>(p));
+  EXPECT_EQ(p.useCount(), 1);
+  EXPECT_TRUE(p.unique());
+}
+
+TEST_F(NoAllocExpected, AtomicReset) {
+  AtomicPtr p(data);
+  p.reset();
+
+  AtomicPtr q(data);
+  q.reset(more_data);
+}
+
+using TargetPtr = NoDanglePtr<Target>;
+
+TEST_F(NoAllocExpected, IntrusivePtrCtor) {
+  Target target(42);
+  TargetPtr p(&target);
+}
+
+TEST_F(NoAllocExpected, IntrusiveCopyCtor) {
+  Target target(42);
+  TargetPtr p(&target);
+  TargetPtr q = p;
+}
+
+TEST_F(NoAllocExpected, IntrusiveMoveCtor) {
+  Target target(42);
+  TargetPtr p(&target);
+  TargetPtr q = std::move(p);
+}
+
+TEST_F(NoAllocExpected, IntrusiveAssign) {
+  Target target(42);
+  Target other(43);
+  TargetPtr p(&target);
+  TargetPtr q(&other);
+  q = p;
+  TargetPtr r;
+  r = std::move(q);
+}
+
+TEST_F(NoAllocExpected, IntrusiveConstOperations) {
+  Target target(42);
+  TargetPtr p(&target);
+  EXPECT_EQ(p.get(), &target);
+  EXPECT_TRUE(static_cast<bool>(p));
+  EXPECT_EQ(p->value, 42);
+  EXPECT_EQ((*p).value, 42);
+  EXPECT_EQ(p.pin().get(), &target);
+}
+
+TEST_F(NoAllocExpected, IntrusiveInvalidate) {
+  std::array<TargetPtr, 16> observers;
+  {
+    Target target(42);
+    for (auto& observer : observers) {
+      observer = TargetPtr(&target);
+    }
+  }
+  for (const auto& observer : observers) {
+    EXPECT_FALSE(static_cast<bool>(observer));
+  }
+}
+
+TEST_F(NoAllocExpected, IntrusiveCopyTarget) {
+  Target target(42);
+  TargetPtr p(&target);
+  {
+    Target copy = target;
+    TargetPtr q(&copy);
+  }
+  EXPECT_TRUE(static_cast<bool>(p));
+}
+
+TEST_F(AllocOnceExpected, IntrusiveDelete) {
+  auto* target = new Target(42);
+  TargetPtr p(target);
+  TargetPtr q = p;
+  delete p;
+  EXPECT_FALSE(static_cast<bool>(q));
+}
+
+TEST_F(AllocOnceExpected, AtomicMake) {
+  auto p = makeAtomicListPtr<int>(42);
+}
+
+TEST(AllocationBudgetTest, ListPtrOperations) {
+  auto* first = new A(42);
+  auto* second = new A(43);
+
+  ScopedAllocationBudget budget(0);
+  ListPtr<A> p(first);
+  ListPtr<A> q = p;
+  ListPtr<A> r(second);
+  r = q;
+  r = std::move(q);
+  ListWeakPtr<A> w = r;
+  EXPECT_FALSE(w.expired());
+  EXPECT_EQ(2, r.useCount());
+  EXPECT_FALSE(r.unique());
+  r.reset();
+  EXPECT_TRUE(p.unique());
+  p.resetAll();
+  EXPECT_TRUE(w.expired());
+}
+
+TEST(AllocationBudgetTest, SinglyLinkedOperations) {
+  auto* object = new A(42);
+
+  ScopedAllocationBudget budget(0);
+  SinglyLinkedPtr p(object);
+  std::array<SinglyLinkedPtr, 8> owners;
+  for (auto& owner : owners) {
+    owner = p;
+  }
+  EXPECT_EQ(owners.size() + 1, p.useCount());
+  p.resetAll();
+}
+
+TEST(AllocationBudgetTest, MakeListPtr) {
+  ScopedAllocationBudget budget(1);
+  auto p = makeListPtr<A>(42);
+  auto q = p;
+  EXPECT_EQ(sizeof(A), budget.counters().allocated_bytes);
+}
+
+TEST(AllocationBudgetTest, DeferredDeleter) {
+  DeferredQueue queue(16);
+  auto* object = new A(42);
+
+  ScopedAllocationBudget budget(0);
+  {
+    ListPtr<A, DeferredDeleter<A>> p(object, DeferredDeleter<A>(queue));
+    auto q = p;
+  }
+  EXPECT_EQ(1, queue.drain());
+}
+
+TEST(AllocationBudgetTest, DeferredDeleterThreadQueue) {
+  std::thread([] {
+    threadDeferredQueue();
+    auto* object = new A(42);
+    {
+      ScopedAllocationBudget budget(0);
+      ListPtr<A, DeferredDeleter<A>> p(object);
+      auto q = p;
+    }
+    EXPECT_EQ(1, drainDeferred());
+  }).join();
+}
+
+TEST(AllocationBudgetTest, DeferredDeleterThreadQueueFirstUse) {
+  std::thread([] {
+    auto* object = new A(42);
+    {
+      // The thread has no queue, so the object is destroyed immediately instead of creating one.
+      ScopedAllocationBudget budget(0);
+      {
+        ListPtr<A, DeferredDeleter<A>> p(object);
+      }
+      EXPECT_EQ(0, budget.counters().allocations);
+    }
+    EXPECT_EQ(nullptr, existingThreadDeferredQueue());
+  }).join();
+}
+
+TEST(AllocationBudgetTest, IntrusiveNoDanglePtrOperations) {
+  ScopedAllocationBudget budget(0);
+  Target target(42);
+  Target other(43);
+  std::array<TargetPtr, 8> observers;
+  for (auto& observer : observers) {
+    observer = TargetPtr(&target);
+  }
+  TargetPtr p(&other);
+  p = observers.front();
+  TargetPtr q = std::move(p);
+  {
+    auto pin = q.pin();
+    EXPECT_EQ(42, pin->value);
+  }
+}
+
 } // namespace ct::test
@@ -0,0 +1,139 @@
+#include "atomic-list-ptr.h"
+#include "concurrency.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <barrier>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ct::test {
+
+namespace {
+
+struct DestructionCounter {
+  explicit DestructionCounter(std::atomic<std::size_t>* destroyed)
+      : destroyed(destroyed) {}
+
+  DestructionCounter(const DestructionCounter&) = delete;
+  DestructionCounter& operator=(const DestructionCounter&) = delete;
+
+  ~DestructionCounter() {
+    destroyed->fetch_add(1);
+  }
+
+private:
+  std::atomic<std::size_t>* destroyed;
+};
+
+} // namespace
+
+using AtomicPtr = AtomicListPtr<DestructionCounter>;
+
+TEST(AtomicListPtrTest, SingleThread) {
+  std::atomic<std::size_t> destroyed = 0;
+  {
+    AtomicPtr p(new DestructionCounter(&destroyed));
+    EXPECT_EQ(1, p.useCount());
+    {
+      AtomicPtr q = p;
+      EXPECT_EQ(2, p.useCount());
+      EXPECT_TRUE(p == q);
+      AtomicPtr r = std::move(q);
+      EXPECT_FALSE(static_cast<bool>(q));
+      EXPECT_EQ(2, r.useCount());
+    }
+    EXPECT_TRUE(p.unique());
+    EXPECT_EQ(0, destroyed);
+  }
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(AtomicListPtrTest, Make) {
+  auto p = makeAtomicListPtr<int>(42);
+  EXPECT_EQ(42, *p);
+  EXPECT_EQ(1, p.useCount());
+}
+
+TEST(AtomicListPtrTest, ConcurrentCopiesOfSameOwner) {
+  std::atomic<std::size_t> destroyed = 0;
+  {
+    const AtomicPtr root(new DestructionCounter(&destroyed));
+    runConcurrently([&](std::size_t) {
+      std::vector<AtomicPtr> copies;
+      copies.reserve(iterations);
+      for (std::size_t i = 0; i < iterations; ++i) {
+        copies.push_back(root);
+      }
+      for (const auto& copy : copies) {
+        EXPECT_EQ(root.get(), copy.get());
+      }
+    });
+    EXPECT_EQ(0, destroyed);
+    EXPECT_EQ(1, root.useCount());
+  }
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(AtomicListPtrTest, ConcurrentCopyAndDestroy) {
+  std::atomic<std::size_t> destroyed = 0;
+  {
+    std::vector<AtomicPtr> owners(threads_count, AtomicPtr(new DestructionCounter(&destroyed)));
+    runConcurrently([&](std::size_t thread) {
+      for (std::size_t i = 0; i < iterations; ++i) {
+        AtomicPtr copy = owners[thread];
+        AtomicPtr other = owners[(thread + i) % threads_count];
+        copy = other;
+        AtomicPtr moved = std::move(other);
+      }
+    });
+    EXPECT_EQ(0, destroyed);
+    EXPECT_EQ(threads_count, owners.front().useCount());
+  }
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(AtomicListPtrTest, ConcurrentDestructionOfLastOwners) {
+  for (std::size_t round = 0; round < rounds; ++round) {
+    std::atomic<std::size_t> destroyed = 0;
+    std::vector<AtomicPtr> owners(threads_count, AtomicPtr(new DestructionCounter(&destroyed)));
+    std::barrier start(threads_count);
+    runConcurrently([&](std::size_t thread) {
+      start.arrive_and_wait();
+      owners[thread].reset();
+    });
+    EXPECT_EQ(1, destroyed);
+  }
+}
+
+TEST(AtomicListPtrTest, ConcurrentReassignment) {
+  std::atomic<std::size_t> destroyed = 0;
+  {
+    const AtomicPtr first(new DestructionCounter(&destroyed));
+    const AtomicPtr second(new DestructionCounter(&destroyed));
+    runConcurrently([&](std::size_t thread) {
+      AtomicPtr p;
+      for (std::size_t i = 0; i < iterations; ++i) {
+        p = (thread + i) % 2 == 0 ? first : second;
+      }
+    });
+    EXPECT_EQ(0, destroyed);
+    EXPECT_EQ(1, first.useCount());
+    EXPECT_EQ(1, second.useCount());
+  }
+  EXPECT_EQ(2, destroyed);
+}
+
+TEST(AtomicListPtrTest, Noexcept) {
+  static_assert(std::is_nothrow_copy_constructible_v<AtomicPtr>);
+  static_assert(std::is_nothrow_move_constructible_v<AtomicPtr>);
+  static_assert(std::is_nothrow_copy_assignable_v<AtomicPtr>);
+  static_assert(std::is_nothrow_move_assignable_v<AtomicPtr>);
+  static_assert(noexcept(std::declval<AtomicPtr&>().reset()));
+  static_assert(noexcept(std::declval<const AtomicPtr&>().useCount()));
+}
+
+} // namespace ct::test
@@ -0,0 +1,175 @@
+#include "atomic-no-dangle-ptr.h"
+#include "concurrency.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <barrier>
+#include <cstddef>
+#include <vector>
+
+namespace ct::test {
+
+namespace {
+
+struct Session {
+  explicit Session(std::atomic<std::size_t>* destroyed)
+      : destroyed(destroyed) {}
+
+  Session(const Session&) = delete;
+  Session& operator=(const Session&) = delete;
+
+  ~Session() {
+    alive = false;
+    destroyed->fetch_add(1);
+  }
+
+  bool alive = true;
+
+private:
+  std::atomic<std::size_t>* destroyed;
+};
+
+} // namespace
+
+using SessionPtr = AtomicNoDanglePtr<Session>;
+
+TEST(AtomicNoDanglePtrTest, DefaultCtor) {
+  SessionPtr p;
+  EXPECT_FALSE(static_cast<bool>(p));
+  EXPECT_FALSE(static_cast<bool>(p.pin()));
+  p.destroy();
+}
+
+TEST(AtomicNoDanglePtrTest, Pin) {
+  std::atomic<std::size_t> destroyed = 0;
+  auto* session = new Session(&destroyed);
+  SessionPtr p(session);
+  {
+    auto pin = p.pin();
+    EXPECT_TRUE(static_cast<bool>(pin));
+    EXPECT_EQ(session, pin.get());
+    EXPECT_TRUE(pin->alive);
+    EXPECT_TRUE((*pin).alive);
+  }
+  p.destroy();
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(AtomicNoDanglePtrTest, Destroy) {
+  std::atomic<std::size_t> destroyed = 0;
+  SessionPtr p(new Session(&destroyed));
+  SessionPtr q = p;
+  SessionPtr r;
+  r = q;
+
+  q.destroy();
+  EXPECT_EQ(1, destroyed);
+  EXPECT_FALSE(static_cast<bool>(p));
+  EXPECT_FALSE(static_cast<bool>(q));
+  EXPECT_FALSE(static_cast<bool>(r.pin()));
+
+  r.destroy();
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(AtomicNoDanglePtrTest, PinDefersDestruction) {
+  std::atomic<std::size_t> destroyed = 0;
+  SessionPtr p(new Session(&destroyed));
+  SessionPtr q = p;
+  {
+    auto pin = p.pin();
+    q.destroy();
+    EXPECT_FALSE(static_cast<bool>(p));
+    EXPECT_FALSE(static_cast<bool>(q.pin()));
+    EXPECT_EQ(0, destroyed);
+    EXPECT_TRUE(pin->alive);
+  }
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(AtomicNoDanglePtrTest, MovePin) {
+  std::atomic<std::size_t> destroyed = 0;
+  SessionPtr p(new Session(&destroyed));
+  SessionPtr::Pin outer;
+  {
+    auto pin = p.pin();
+    outer = std::move(pin);
+    EXPECT_FALSE(static_cast<bool>(pin));
+  }
+  p.destroy();
+  EXPECT_EQ(0, destroyed);
+  EXPECT_TRUE(outer->alive);
+  outer = SessionPtr::Pin();
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(AtomicNoDanglePtrTest, MoveCtor) {
+  std::atomic<std::size_t> destroyed = 0;
+  SessionPtr p(new Session(&destroyed));
+  SessionPtr q = std::move(p);
+  EXPECT_FALSE(static_cast<bool>(p));
+  EXPECT_TRUE(static_cast<bool>(q));
+  q.destroy();
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(AtomicNoDanglePtrTest, ConcurrentPinAndDestroy) {
+  for (std::size_t round = 0; round < rounds; ++round) {
+    std::atomic<std::size_t> destroyed = 0;
+    const SessionPtr shared(new Session(&destroyed));
+    std::barrier start(threads_count);
+
+    runConcurrently([&](std::size_t thread) {
+      SessionPtr p = shared;
+      start.arrive_and_wait();
+      if (thread == 0) {
+        p.destroy();
+        return;
+      }
+      for (std::size_t i = 0; i < iterations / rounds; ++i) {
+        auto pin = p.pin();
+        if (pin) {
+          EXPECT_TRUE(pin->alive);
+        }
+      }
+    });
+
+    EXPECT_EQ(1, destroyed);
+    EXPECT_FALSE(static_cast<bool>(shared.pin()));
+  }
+}
+
+TEST(AtomicNoDanglePtrTest, ConcurrentDestroy) {
+  for (std::size_t round = 0; round < rounds; ++round) {
+    std::atomic<std::size_t> destroyed = 0;
+    std::vector<SessionPtr> copies(threads_count, SessionPtr(new Session(&destroyed)));
+    std::barrier start(threads_count);
+
+    runConcurrently([&](std::size_t thread) {
+      start.arrive_and_wait();
+      copies[thread].destroy();
+    });
+
+    EXPECT_EQ(1, destroyed);
+  }
+}
+
+TEST(AtomicNoDanglePtrTest, ConcurrentCopies) {
+  std::atomic<std::size_t> destroyed = 0;
+  const SessionPtr shared(new Session(&destroyed));
+
+  runConcurrently([&](std::size_t) {
+    for (std::size_t i = 0; i < iterations; ++i) {
+      SessionPtr p = shared;
+      SessionPtr q = std::move(p);
+      EXPECT_TRUE(q.pin()->alive);
+    }
+  });
+
+  EXPECT_EQ(0, destroyed);
+  SessionPtr(shared).destroy();
+  EXPECT_EQ(1, destroyed);
+}
+
+} // namespace ct::test
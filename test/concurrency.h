@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Parameters and helpers shared by the tests of pointers, which are used from several threads.
+
+namespace ct::test {
+
+inline constexpr std::size_t threads_count = 8;
+inline constexpr std::size_t iterations = 10'000;
+inline constexpr std::size_t rounds = 200;
+
+// Runs `f(i)` in `threads_count` threads, where `i` is the index of the thread, and joins them.
+template <typename F>
+void runConcurrently(F f) {
+  std::vector<std::jthread> threads;
+  threads.reserve(threads_count);
+  for (std::size_t i = 0; i < threads_count; ++i) {
+    threads.emplace_back(f, i);
+  }
+}
+
+} // namespace ct::test
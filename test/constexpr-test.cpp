@@ -0,0 +1,210 @@
+#include "list-ptr.h"
+#include "no-dangle-ptr.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <utility>
+
+// Every check is a constexpr function, which is evaluated both by `static_assert` and at run time,
+// so that a failure in constant evaluation may also be debugged as an ordinary test.
+
+namespace ct::test {
+
+namespace {
+
+struct Counted {
+  constexpr Counted(int value, int* destroyed)
+      : value(value)
+      , destroyed(destroyed) {}
+
+  constexpr ~Counted() {
+    ++*destroyed;
+  }
+
+  int value;
+  int* destroyed;
+};
+
+struct Base {
+  constexpr virtual ~Base() = default;
+
+  constexpr virtual int id() const {
+    return 1;
+  }
+};
+
+struct Derived : Base {
+  constexpr int id() const override {
+    return 2;
+  }
+};
+
+struct Target : NoDangleTarget {
+  constexpr explicit Target(int value)
+      : value(value) {}
+
+  int value;
+};
+
+constexpr bool listPtrConstruction() {
+  ListPtr<int> empty;
+  ListPtr<int> null(nullptr);
+  ListPtr<int> p(new int(42));
+  return !empty && !null && p && *p == 42 && p.unique() && p.useCount() == 1;
+}
+
+constexpr bool listPtrCopy() {
+  int destroyed = 0;
+  {
+    ListPtr<Counted> p(new Counted(42, &destroyed));
+    ListPtr<Counted> q = p;
+    ListPtr<Counted> r;
+    r = q;
+    if (p.useCount() != 3 || p != r || r->value != 42) {
+      return false;
+    }
+    q.reset();
+    if (p.useCount() != 2 || destroyed != 0) {
+      return false;
+    }
+  }
+  return destroyed == 1;
+}
+
+constexpr bool listPtrMove() {
+  int destroyed = 0;
+  {
+    ListPtr<Counted> p(new Counted(42, &destroyed));
+    ListPtr<Counted> q = std::move(p);
+    ListPtr<Counted> r;
+    r = std::move(q);
+    if (p || q || !r.unique() || r->value != 42) {
+      return false;
+    }
+  }
+  return destroyed == 1;
+}
+
+constexpr bool listPtrReset() {
+  int destroyed = 0;
+  ListPtr<Counted> p(new Counted(1, &destroyed));
+  ListPtr<Counted> q = p;
+  p.reset(new Counted(2, &destroyed));
+  if (destroyed != 0 || p->value != 2 || q->value != 1) {
+    return false;
+  }
+  q.reset();
+  p.reset();
+  return destroyed == 2 && !p && !q;
+}
+
+constexpr bool listPtrRelease() {
+  ListPtr<int> p(new int(42));
+  int* raw = p.release();
+  bool result = !p && *raw == 42;
+  delete raw;
+  return result;
+}
+
+constexpr bool listPtrConversion() {
+  ListPtr<Derived> derived(new Derived());
+  ListPtr<Base> base = derived;
+  return base->id() == 2 && derived.useCount() == 2;
+}
+
+constexpr bool makeListPtrObject() {
+  int destroyed = 0;
+  {
+    auto p = makeListPtr<Counted>(42, &destroyed);
+    auto q = p;
+    if (q->value != 42 || p.useCount() != 2) {
+      return false;
+    }
+  }
+  return destroyed == 1;
+}
+
+constexpr bool makeListPtrArray() {
+  auto unbounded = makeListPtr<int[]>(4);
+  auto bounded = makeListPtr<int[3]>();
+  unbounded[3] = 1;
+  bounded[2] = 2;
+  return unbounded[0] == 0 && unbounded[3] == 1 && bounded[0] == 0 && bounded[2] == 2;
+}
+
+constexpr bool listPtrSinglyLinked() {
+  ListPtr<int, std::default_delete<int>, SinglyLinked> p(new int(42));
+  auto q = p;
+  auto r = q;
+  q.reset();
+  return p.useCount() == 2 && *r == 42;
+}
+
+constexpr bool listPtrHybridLinked() {
+  ListPtr<int, std::default_delete<int>, HybridLinked<2>> p(new int(42));
+  ListPtr<int, std::default_delete<int>, HybridLinked<2>> owners[4] = {p, p, p, p};
+  owners[0].reset();
+  return p.useCount() == 4 && *owners[3] == 42;
+}
+
+constexpr bool noDanglePtrCopy() {
+  auto* target = new Target(42);
+  NoDanglePtr<Target> p(target);
+  NoDanglePtr<Target> q = p;
+  NoDanglePtr<Target> r;
+  r = std::move(q);
+  bool alive = p && r && r->value == 42 && p.get() == target;
+  delete target;
+  return alive && !p && !r;
+}
+
+constexpr bool noDanglePtrLocalTarget() {
+  NoDanglePtr<Target> p;
+  {
+    Target target(42);
+    p = NoDanglePtr<Target>(&target);
+    if ((*p).value != 42) {
+      return false;
+    }
+  }
+  return !p;
+}
+
+} // namespace
+
+static_assert(listPtrConstruction());
+static_assert(listPtrCopy());
+static_assert(listPtrMove());
+static_assert(listPtrReset());
+static_assert(listPtrRelease());
+static_assert(listPtrConversion());
+static_assert(makeListPtrObject());
+static_assert(makeListPtrArray());
+static_assert(listPtrSinglyLinked());
+static_assert(listPtrHybridLinked());
+static_assert(noDanglePtrCopy());
+static_assert(noDanglePtrLocalTarget());
+
+TEST(ConstexprTest, ListPtr) {
+  EXPECT_TRUE(listPtrConstruction());
+  EXPECT_TRUE(listPtrCopy());
+  EXPECT_TRUE(listPtrMove());
+  EXPECT_TRUE(listPtrReset());
+  EXPECT_TRUE(listPtrRelease());
+  EXPECT_TRUE(listPtrConversion());
+  EXPECT_TRUE(listPtrSinglyLinked());
+  EXPECT_TRUE(listPtrHybridLinked());
+}
+
+TEST(ConstexprTest, MakeListPtr) {
+  EXPECT_TRUE(makeListPtrObject());
+  EXPECT_TRUE(makeListPtrArray());
+}
+
+TEST(ConstexprTest, NoDanglePtr) {
+  EXPECT_TRUE(noDanglePtrCopy());
+  EXPECT_TRUE(noDanglePtrLocalTarget());
+}
+
+} // namespace ct::test
@@ -0,0 +1,247 @@
+#include "cycle-collector.h"
+#include "list-ptr.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace ct::test {
+
+namespace {
+
+struct Node {
+  explicit Node(std::size_t* destroyed)
+      : destroyed(destroyed) {}
+
+  Node(const Node&) = delete;
+  Node& operator=(const Node&) = delete;
+
+  ~Node() {
+    ++*destroyed;
+  }
+
+  // Children are stored outside of the node, in the buffer of the vector, so they are found only by tracing.
+  void trace(CycleTracer& tracer) {
+    tracer(parent);
+    for (auto& child : children) {
+      tracer(child);
+    }
+  }
+
+  ListPtr<Node> parent;
+  std::vector<ListPtr<Node>> children;
+
+private:
+  std::size_t* destroyed;
+};
+
+struct HybridNode;
+
+using HybridNodePtr = ListPtr<HybridNode, std::default_delete<HybridNode>, HybridLinked<2>>;
+
+struct HybridNode {
+  explicit HybridNode(std::size_t* destroyed)
+      : destroyed(destroyed) {}
+
+  HybridNode(const HybridNode&) = delete;
+  HybridNode& operator=(const HybridNode&) = delete;
+
+  ~HybridNode() {
+    ++*destroyed;
+  }
+
+  void trace(CycleTracer& tracer) {
+    for (auto& edge : edges) {
+      tracer(edge);
+    }
+  }
+
+  std::vector<HybridNodePtr> edges;
+
+private:
+  std::size_t* destroyed;
+};
+
+struct Untraceable {};
+
+} // namespace
+
+class CycleCollectorTest : public ::testing::Test {
+protected:
+  ListPtr<Node> makeNode() {
+    ListPtr<Node> node(new Node(&destroyed));
+    collector.track(node);
+    return node;
+  }
+
+  ListPtr<Node> addChild(const ListPtr<Node>& parent) {
+    auto child = makeNode();
+    child->parent = parent;
+    parent->children.push_back(child);
+    return child;
+  }
+
+  std::size_t destroyed = 0;
+  CycleCollector collector;
+};
+
+TEST_F(CycleCollectorTest, Empty) {
+  EXPECT_EQ(0, collector.collect());
+  EXPECT_EQ(0, collector.tracked());
+}
+
+TEST_F(CycleCollectorTest, AcyclicObjectsAreDropped) {
+  {
+    auto node = makeNode();
+    EXPECT_EQ(1, collector.tracked());
+  }
+  EXPECT_EQ(1, destroyed);
+  EXPECT_EQ(0, collector.collect());
+  EXPECT_EQ(0, collector.tracked());
+}
+
+TEST_F(CycleCollectorTest, SelfCycle) {
+  {
+    auto node = makeNode();
+    node->parent = node;
+  }
+  EXPECT_EQ(0, destroyed);
+  EXPECT_EQ(1, collector.collect());
+  EXPECT_EQ(1, destroyed);
+  EXPECT_EQ(0, collector.tracked());
+}
+
+TEST_F(CycleCollectorTest, ParentChildCycle) {
+  {
+    auto root = makeNode();
+    auto child = addChild(root);
+    addChild(child);
+  }
+  EXPECT_EQ(0, destroyed);
+  EXPECT_EQ(3, collector.collect());
+  EXPECT_EQ(3, destroyed);
+}
+
+TEST_F(CycleCollectorTest, LiveCycleIsKept) {
+  auto root = makeNode();
+  addChild(root);
+  addChild(root);
+
+  EXPECT_EQ(0, collector.collect());
+  EXPECT_EQ(0, destroyed);
+  EXPECT_EQ(3, collector.tracked());
+
+  root.reset();
+  EXPECT_EQ(3, collector.collect());
+  EXPECT_EQ(3, destroyed);
+}
+
+TEST_F(CycleCollectorTest, ReachableFromExternalOwner) {
+  ListPtr<Node> leaf;
+  {
+    auto root = makeNode();
+    leaf = addChild(addChild(root));
+  }
+  EXPECT_EQ(0, collector.collect());
+  EXPECT_EQ(0, destroyed);
+
+  leaf.reset();
+  EXPECT_EQ(3, collector.collect());
+  EXPECT_EQ(3, destroyed);
+}
+
+TEST_F(CycleCollectorTest, UntrackedOwnerIsExternal) {
+  auto holder = makeListPtr<std::vector<ListPtr<Node>>>();
+  {
+    auto root = makeNode();
+    addChild(root);
+    holder->push_back(root);
+  }
+  EXPECT_EQ(0, collector.collect());
+
+  holder.reset();
+  EXPECT_EQ(2, collector.collect());
+  EXPECT_EQ(2, destroyed);
+}
+
+TEST_F(CycleCollectorTest, TrackTwice) {
+  auto node = makeNode();
+  collector.track(node);
+  collector.track(ListPtr<Node>());
+  EXPECT_EQ(1, collector.tracked());
+}
+
+TEST_F(CycleCollectorTest, Incremental) {
+  for (std::size_t i = 0; i < 10; ++i) {
+    auto root = makeNode();
+    addChild(addChild(root));
+  }
+
+  std::size_t steps = 0;
+  while (!collector.collectStep(4)) {
+    ++steps;
+  }
+  EXPECT_LT(0, steps);
+  EXPECT_EQ(30, collector.lastCollected());
+  EXPECT_EQ(30, destroyed);
+}
+
+TEST_F(CycleCollectorTest, MutationBetweenSteps) {
+  ListPtr<Node> rescued;
+  {
+    auto root = makeNode();
+    for (std::size_t i = 0; i < 8; ++i) {
+      addChild(root);
+    }
+    rescued = root->children.front();
+  }
+  auto weak = ListWeakPtr<Node>(rescued);
+  rescued.reset();
+
+  EXPECT_FALSE(collector.collectStep(1));
+  rescued = weak.lock();
+  while (!collector.collectStep(1)) {
+  }
+  EXPECT_EQ(0, destroyed);
+
+  rescued.reset();
+  EXPECT_EQ(9, collector.collect());
+  EXPECT_EQ(9, destroyed);
+}
+
+TEST_F(CycleCollectorTest, PromotedHybridGroup) {
+  std::size_t hybrid_destroyed = 0;
+  {
+    HybridNodePtr node(new HybridNode(&hybrid_destroyed));
+    collector.track(node);
+    // More owners than the threshold, so the group of the node is promoted to a counted block.
+    node->edges.assign(8, node);
+  }
+  EXPECT_EQ(0, hybrid_destroyed);
+  EXPECT_EQ(1, collector.collect());
+  EXPECT_EQ(1, hybrid_destroyed);
+}
+
+template <typename P>
+concept Trackable = requires(CycleCollector& collector, const P& ptr) { collector.track(ptr); };
+
+TEST(CycleCollectorTraitsTest, Traceable) {
+  static_assert(CycleTraceable<Node>);
+  static_assert(!CycleTraceable<Untraceable>);
+  static_assert(Trackable<ListPtr<Node>>);
+  static_assert(!Trackable<ListPtr<Untraceable>>);
+}
+
+TEST(DefaultCycleCollectorTest, CollectCycles) {
+  std::size_t destroyed = 0;
+  {
+    ListPtr<Node> node(new Node(&destroyed));
+    trackCycles(node);
+    node->parent = node;
+  }
+  EXPECT_EQ(1, collectCycles());
+  EXPECT_EQ(1, destroyed);
+}
+
+} // namespace ct::test
@@ -0,0 +1,168 @@
+#include "deferred-deleter.h"
+#include "list-ptr.h"
+#include "test-classes.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace ct::test {
+
+namespace {
+
+struct Counted {
+  explicit Counted(std::atomic<std::size_t>* destroyed)
+      : destroyed(destroyed) {}
+
+  Counted(const Counted&) = delete;
+  Counted& operator=(const Counted&) = delete;
+
+  ~Counted() {
+    destroyed->fetch_add(1);
+  }
+
+private:
+  std::atomic<std::size_t>* destroyed;
+};
+
+void destroyCounted(void* object) {
+  delete static_cast<Counted*>(object);
+}
+
+} // namespace
+
+using DeferredPtr = ListPtr<DestructionTracker, DeferredDeleter<DestructionTracker>>;
+using CountedPtr = ListPtr<Counted, DeferredDeleter<Counted>>;
+
+TEST(DeferredDeleterTest, DeferredUntilDrain) {
+  threadDeferredQueue().drain();
+  bool deleted = false;
+  DeferredPtr p(new DestructionTracker(&deleted), DeferredDeleter<DestructionTracker>());
+  DeferredPtr q = p;
+  p.reset();
+  q.reset();
+  EXPECT_FALSE(deleted);
+  EXPECT_EQ(1, threadDeferredQueue().size());
+
+  EXPECT_EQ(1, drainDeferred());
+  EXPECT_TRUE(deleted);
+  EXPECT_EQ(0, drainDeferred());
+}
+
+TEST(DeferredDeleterTest, Batch) {
+  threadDeferredQueue().drain();
+  std::atomic<std::size_t> destroyed = 0;
+  {
+    std::vector<CountedPtr> owners;
+    for (std::size_t i = 0; i < 100; ++i) {
+      owners.emplace_back(new Counted(&destroyed), DeferredDeleter<Counted>());
+    }
+  }
+  EXPECT_EQ(0, destroyed);
+  EXPECT_EQ(100, drainDeferred());
+  EXPECT_EQ(100, destroyed);
+}
+
+TEST(DeferredDeleterTest, ExplicitQueue) {
+  std::atomic<std::size_t> destroyed = 0;
+  DeferredQueue queue(16);
+  {
+    CountedPtr p(new Counted(&destroyed), DeferredDeleter<Counted>(queue));
+  }
+  EXPECT_EQ(0, threadDeferredQueue().size());
+  EXPECT_EQ(1, queue.size());
+  EXPECT_EQ(0, destroyed);
+  EXPECT_EQ(1, queue.drain());
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(DeferredDeleterTest, FullQueueDestroysInline) {
+  std::atomic<std::size_t> destroyed = 0;
+  DeferredQueue queue(2);
+  for (std::size_t i = 0; i < 3; ++i) {
+    queue.push(new Counted(&destroyed), &destroyCounted);
+  }
+  EXPECT_EQ(1, destroyed);
+  EXPECT_EQ(2, queue.drain());
+  EXPECT_EQ(3, destroyed);
+}
+
+TEST(DeferredDeleterTest, QueueDestructorDrains) {
+  std::atomic<std::size_t> destroyed = 0;
+  {
+    DeferredQueue queue;
+    queue.push(new Counted(&destroyed), &destroyCounted);
+    queue.push(new Counted(&destroyed), &destroyCounted);
+    EXPECT_EQ(0, destroyed);
+  }
+  EXPECT_EQ(2, destroyed);
+}
+
+TEST(DeferredDeleterTest, ThreadExitDrains) {
+  std::atomic<std::size_t> destroyed = 0;
+  std::thread([&] {
+    threadDeferredQueue();
+    CountedPtr p(new Counted(&destroyed), DeferredDeleter<Counted>());
+    p.reset();
+    EXPECT_EQ(0, destroyed);
+  }).join();
+  EXPECT_EQ(1, destroyed);
+}
+
+TEST(DeferredDeleterTest, NoThreadQueue) {
+  std::thread([] {
+    bool deleted = false;
+    DeferredPtr p(new DestructionTracker(&deleted), DeferredDeleter<DestructionTracker>());
+    p.reset();
+    EXPECT_TRUE(deleted);
+    EXPECT_EQ(nullptr, existingThreadDeferredQueue());
+    EXPECT_EQ(0, drainDeferred());
+  }).join();
+}
+
+TEST(DeferredDeleterTest, BackgroundReclaimer) {
+  constexpr std::size_t producers_count = 4;
+  constexpr std::size_t objects_count = 10'000;
+
+  std::atomic<std::size_t> destroyed = 0;
+  DeferredQueue queue(256);
+  {
+    std::jthread reclaimer([&](std::stop_token stop) {
+      while (!stop.stop_requested()) {
+        queue.drain();
+        std::this_thread::yield();
+      }
+    });
+
+    std::vector<std::jthread> producers;
+    for (std::size_t i = 0; i < producers_count; ++i) {
+      producers.emplace_back([&] {
+        for (std::size_t j = 0; j < objects_count; ++j) {
+          CountedPtr p(new Counted(&destroyed), DeferredDeleter<Counted>(queue));
+          CountedPtr q = p;
+        }
+      });
+    }
+  }
+  queue.drain();
+  EXPECT_EQ(producers_count * objects_count, destroyed);
+}
+
+TEST(DeferredDeleterTest, Conversion) {
+  threadDeferredQueue().drain();
+  bool deleted = false;
+  {
+    ListPtr<DestructionTracker, DeferredDeleter<DestructionTracker>> p(
+        new DestructionTracker(&deleted), DeferredDeleter<DestructionTracker>()
+    );
+    ListPtr<DestructionTrackerBase, DeferredDeleter<DestructionTrackerBase>> q = p;
+  }
+  EXPECT_FALSE(deleted);
+  drainDeferred();
+  EXPECT_TRUE(deleted);
+}
+
+} // namespace ct::test
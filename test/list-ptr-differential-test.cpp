@@ -0,0 +1,59 @@
+#include "list-ptr-differential.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ct::test::differential {
+
+namespace {
+
+inline constexpr std::size_t steps_count = 20'000;
+inline constexpr std::size_t bytes_per_step = 3;
+
+std::vector<std::uint8_t> randomBytes(std::uint32_t seed, std::size_t count) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<unsigned> distribution(0, 255);
+  std::vector<std::uint8_t> bytes(count);
+  for (auto& byte : bytes) {
+    byte = static_cast<std::uint8_t>(distribution(generator));
+  }
+  return bytes;
+}
+
+template <typename Links>
+void checkMatchesSharedPtr(std::uint32_t seed) {
+  auto bytes = randomBytes(seed, steps_count * bytes_per_step);
+  ByteStream stream(bytes);
+  Model<Links> model;
+  while (!stream.empty()) {
+    model.step(stream);
+    auto mismatch = model.mismatch();
+    ASSERT_FALSE(mismatch.has_value()) << "seed " << seed << ", " << *mismatch;
+  }
+  auto leak = model.tearDown();
+  EXPECT_FALSE(leak.has_value()) << "seed " << seed << ", " << *leak;
+}
+
+} // namespace
+
+class ListPtrDifferentialTest : public ::testing::TestWithParam<std::uint32_t> {};
+
+TEST_P(ListPtrDifferentialTest, MatchesSharedPtr) {
+  checkMatchesSharedPtr<DoublyLinked>(GetParam());
+}
+
+TEST_P(ListPtrDifferentialTest, SinglyLinkedMatchesSharedPtr) {
+  checkMatchesSharedPtr<SinglyLinked>(GetParam());
+}
+
+TEST_P(ListPtrDifferentialTest, HybridLinkedMatchesSharedPtr) {
+  checkMatchesSharedPtr<HybridLinked<2>>(GetParam());
+}
+
+INSTANTIATE_TEST_SUITE_P(Seeds, ListPtrDifferentialTest, ::testing::Range<std::uint32_t>(0, 16));
+
+} // namespace ct::test::differential
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "list-ptr.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Differential model of `ListPtr`: every operation is applied both to a pool of `ListPtr`s and to a mirror pool
+// of `std::shared_ptr`s, after which the pools must agree on `get()`, `useCount()` and on which objects are destroyed.
+// Operations are decoded from a byte stream, so the model may be driven by a seeded generator or by a fuzzer.
+// It does not depend on GTest.
+
+namespace ct::test::differential {
+
+enum class Side : std::size_t {
+  List,
+  Shared,
+};
+
+// Destruction log of both sides: objects with the same id are created on both sides at the same step.
+class Registry {
+public:
+  std::size_t create() {
+    destroyed[0].push_back(false);
+    destroyed[1].push_back(false);
+    return destroyed[0].size() - 1;
+  }
+
+  void destroy(Side side, std::size_t id) {
+    auto&& flag = destroyed[static_cast<std::size_t>(side)][id];
+    if (flag) {
+      double_destruction = true;
+    }
+    flag = true;
+    recent.push_back(id);
+  }
+
+  // Ids of the objects destroyed on either side since the last `clearRecent()`, possibly repeated.
+  const std::vector<std::size_t>& recentlyDestroyed() const {
+    return recent;
+  }
+
+  void clearRecent() {
+    recent.clear();
+  }
+
+  // The number of ids created so far, which are `0, 1, ..., created() - 1`.
+  std::size_t created() const {
+    return destroyed[0].size();
+  }
+
+  bool isDestroyed(Side side, std::size_t id) const {
+    return destroyed[static_cast<std::size_t>(side)][id];
+  }
+
+  bool doubleDestruction() const {
+    return double_destruction;
+  }
+
+private:
+  std::array<std::vector<bool>, 2> destroyed;
+  std::vector<std::size_t> recent;
+  bool double_destruction = false;
+};
+
+struct Base {
+  Base(Registry* registry, Side side, std::size_t id)
+      : registry(registry)
+      , side(side)
+      , id(id) {}
+
+  Base(const Base&) = delete;
+  Base& operator=(const Base&) = delete;
+
+  virtual ~Base() {
+    registry->destroy(side, id);
+  }
+
+  Registry* registry;
+  Side side;
+  std::size_t id;
+};
+
+struct Derived : Base {
+  using Base::Base;
+};
+
+// Sequence of bytes, which returns zeros once exhausted.
+class ByteStream {
+public:
+  explicit ByteStream(std::span<const std::uint8_t> bytes)
+      : bytes(bytes) {}
+
+  bool empty() const {
+    return position == bytes.size();
+  }
+
+  std::uint8_t next() {
+    return empty() ? 0 : bytes[position++];
+  }
+
+private:
+  std::span<const std::uint8_t> bytes;
+  std::size_t position = 0;
+};
+
+// `Links` is the link strategy of the `ListPtr`s, e.g. with `HybridLinked<2>` the groups of the pools
+// keep crossing the threshold in both directions.
+template <typename Links = DoublyLinked>
+class Model {
+public:
+  static constexpr std::size_t pool_size = 8;
+
+  // Applies the next operation from `stream` to both pools.
+  void step(ByteStream& stream) {
+    std::uint8_t op = stream.next();
+    std::size_t a = stream.next() % pool_size;
+    std::size_t b = stream.next() % pool_size;
+
+    switch (op % 14) {
+    case 0:
+      list_base[a] = list_base[b];
+      shared_base[a] = shared_base[b];
+      break;
+    case 1:
+      if (a != b) {
+        list_base[a] = std::move(list_base[b]);
+        shared_base[a] = std::move(shared_base[b]);
+      }
+      break;
+    case 2:
+      list_base[a] = Ptr<Base>(list_base[b]);
+      shared_base[a] = std::shared_ptr<Base>(shared_base[b]);
+      break;
+    case 3: {
+      Ptr<Base> list_moved(std::move(list_base[b]));
+      std::shared_ptr<Base> shared_moved(std::move(shared_base[b]));
+      list_base[a] = list_moved;
+      shared_base[a] = shared_moved;
+      break;
+    }
+    case 4:
+      list_base[a].reset();
+      shared_base[a].reset();
+      break;
+    case 5: {
+      std::size_t id = registry.create();
+      list_base[a].reset(new Derived(&registry, Side::List, id));
+      shared_base[a].reset(new Derived(&registry, Side::Shared, id));
+      break;
+    }
+    case 6: {
+      std::size_t id = registry.create();
+      list_derived[a] = Ptr<Derived>(new Derived(&registry, Side::List, id));
+      shared_derived[a] = std::shared_ptr<Derived>(new Derived(&registry, Side::Shared, id));
+      break;
+    }
+    case 7:
+      list_base[a] = list_derived[b];
+      shared_base[a] = shared_derived[b];
+      break;
+    case 8:
+      list_base[a] = std::move(list_derived[b]);
+      shared_base[a] = std::move(shared_derived[b]);
+      break;
+    case 9:
+      list_base[a] = Ptr<Base>(list_derived[b]);
+      shared_base[a] = std::shared_ptr<Base>(shared_derived[b]);
+      break;
+    case 10:
+      list_base[a] = Ptr<Base>(std::move(list_derived[b]));
+      shared_base[a] = std::shared_ptr<Base>(std::move(shared_derived[b]));
+      break;
+    case 11:
+      list_derived[a] = list_derived[b];
+      shared_derived[a] = shared_derived[b];
+      break;
+    case 12:
+      list_derived[a].reset();
+      shared_derived[a].reset();
+      break;
+    case 13:
+      // `release()` is only compared for unique owners, for which it is equivalent to deleting the object by hand.
+      if (list_base[a].unique() && list_base[a].get()) {
+        delete list_base[a].release();
+        shared_base[a].reset();
+      }
+      break;
+    }
+    ++steps;
+  }
+
+  // Returns a description of the first difference between the pools, if there is any.
+  // Only the objects destroyed since the previous call are compared, so that a check after every step
+  // takes O(pool size + destroyed objects) instead of rescanning every object ever created.
+  std::optional<std::string> mismatch() {
+    if (registry.doubleDestruction()) {
+      return "an object is destroyed twice";
+    }
+    for (std::size_t i = 0; i < pool_size; ++i) {
+      if (auto result = compare("base", i, list_base[i], shared_base[i])) {
+        return result;
+      }
+      if (auto result = compare("derived", i, list_derived[i], shared_derived[i])) {
+        return result;
+      }
+    }
+    for (std::size_t id : registry.recentlyDestroyed()) {
+      if (registry.isDestroyed(Side::List, id) != registry.isDestroyed(Side::Shared, id)) {
+        return describe("object " + std::to_string(id) + " is destroyed on one side only");
+      }
+    }
+    registry.clearRecent();
+    return std::nullopt;
+  }
+
+  // Resets every pointer in both pools and returns a description of the first object, which is left alive
+  // on either side, if there is any. The model must not be stepped afterwards.
+  std::optional<std::string> tearDown() {
+    for (std::size_t i = 0; i < pool_size; ++i) {
+      list_base[i].reset();
+      list_derived[i].reset();
+      shared_base[i].reset();
+      shared_derived[i].reset();
+    }
+    if (registry.doubleDestruction()) {
+      return "an object is destroyed twice";
+    }
+    for (std::size_t id = 0; id < registry.created(); ++id) {
+      if (!registry.isDestroyed(Side::List, id)) {
+        return describe("object " + std::to_string(id) + " is never destroyed by ListPtr");
+      }
+      if (!registry.isDestroyed(Side::Shared, id)) {
+        return describe("object " + std::to_string(id) + " is never destroyed by std::shared_ptr");
+      }
+    }
+    return std::nullopt;
+  }
+
+private:
+  template <typename T>
+  using Ptr = ListPtr<T, std::default_delete<T>, Links>;
+
+  template <typename L, typename S>
+  std::optional<std::string> compare(const char* pool, std::size_t i, const L& list, const S& shared) const {
+    std::string slot = std::string(pool) + "[" + std::to_string(i) + "]";
+    if ((list.get() == nullptr) != (shared.get() == nullptr)) {
+      return describe(slot + ": get() is null on one side only");
+    }
+    if (list.get() && list->id != shared->id) {
+      return describe(
+          slot + ": get() points to object " + std::to_string(list->id) + " instead of " +
+          std::to_string(shared->id)
+      );
+    }
+    if (list.useCount() != static_cast<std::size_t>(shared.use_count())) {
+      return describe(
+          slot + ": useCount() is " + std::to_string(list.useCount()) + " instead of " +
+          std::to_string(shared.use_count())
+      );
+    }
+    if (static_cast<bool>(list) != static_cast<bool>(shared)) {
+      return describe(slot + ": operator bool differs");
+    }
+    return std::nullopt;
+  }
+
+  std::string describe(const std::string& message) const {
+    return "after step " + std::to_string(steps) + ": " + message;
+  }
+
+  // Declared first, so that it outlives the objects in the pools.
+  Registry registry;
+  std::array<Ptr<Base>, pool_size> list_base;
+  std::array<Ptr<Derived>, pool_size> list_derived;
+  std::array<std::shared_ptr<Base>, pool_size> shared_base;
+  std::array<std::shared_ptr<Derived>, pool_size> shared_derived;
+  std::size_t steps = 0;
+};
+
+} // namespace ct::test::differential
@@ -0,0 +1,187 @@
+#include "no-dangle-ptr.h"
+#include "test-classes.h"
+#include "test-object.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ct::test {
+
+class NoDanglePtrPinTest : public ::testing::Test {
+protected:
+  TestObject::NoNewInstancesGuard instances_guard;
+};
+
+using ObjectPtr = NoDanglePtr<TestObject>;
+
+inline static constexpr int magic = 42;
+
+TEST_F(NoDanglePtrPinTest, DefaultPin) {
+  ObjectPtr::Pin pin;
+  EXPECT_FALSE(static_cast<bool>(pin));
+  EXPECT_EQ(nullptr, pin.get());
+}
+
+TEST_F(NoDanglePtrPinTest, PinNull) {
+  ObjectPtr p;
+  EXPECT_FALSE(static_cast<bool>(p.pin()));
+}
+
+TEST_F(NoDanglePtrPinTest, Pin) {
+  auto* obj = new TestObject(magic);
+  ObjectPtr p(obj);
+  ObjectPtr q = p;
+  {
+    auto pin = q.pin();
+    EXPECT_TRUE(static_cast<bool>(pin));
+    EXPECT_EQ(obj, pin.get());
+    EXPECT_EQ(magic, *pin);
+    EXPECT_EQ(magic, static_cast<int>(*pin.operator->()));
+  }
+  delete p;
+  EXPECT_FALSE(static_cast<bool>(q.pin()));
+}
+
+TEST_F(NoDanglePtrPinTest, PinInLoop) {
+  ObjectPtr p(new TestObject(magic));
+  std::size_t sum = 0;
+  {
+    auto pin = p.pin();
+    for (std::size_t i = 0; i < 1000; ++i) {
+      sum += static_cast<std::size_t>(static_cast<int>(*pin));
+    }
+  }
+  EXPECT_EQ(1000 * magic, sum);
+  delete p;
+}
+
+TEST_F(NoDanglePtrPinTest, MovePin) {
+  auto* obj = new TestObject(magic);
+  ObjectPtr p(obj);
+  ObjectPtr::Pin outer;
+  {
+    auto pin = p.pin();
+    outer = std::move(pin);
+    EXPECT_FALSE(static_cast<bool>(pin));
+  }
+  EXPECT_EQ(obj, outer.get());
+  ObjectPtr::Pin moved(std::move(outer));
+  EXPECT_FALSE(static_cast<bool>(outer));
+  EXPECT_EQ(obj, moved.get());
+  moved = ObjectPtr::Pin();
+  delete p;
+}
+
+TEST_F(NoDanglePtrPinTest, DeleteAfterUnpin) {
+  ObjectPtr p(new TestObject(magic));
+  {
+    auto first = p.pin();
+    auto second = p.pin();
+  }
+  delete p;
+  EXPECT_FALSE(static_cast<bool>(p));
+}
+
+#ifndef NDEBUG
+TEST_F(NoDanglePtrPinTest, DeleteWhilePinned) {
+  EXPECT_DEATH(
+      {
+        ObjectPtr p(new TestObject(magic));
+        auto pin = p.pin();
+        delete p;
+      },
+      ""
+  );
+}
+#endif
+
+class NoDangleArenaTest : public ::testing::Test {
+protected:
+  TestObject::NoNewInstancesGuard instances_guard;
+};
+
+TEST_F(NoDangleArenaTest, Empty) {
+  NoDangleArena arena;
+  EXPECT_EQ(0, arena.size());
+  arena.reset();
+  EXPECT_EQ(0, arena.size());
+}
+
+TEST_F(NoDangleArenaTest, Make) {
+  NoDangleArena arena;
+  ObjectPtr p = arena.make<TestObject>(magic);
+  EXPECT_TRUE(static_cast<bool>(p));
+  EXPECT_EQ(magic, *p);
+  EXPECT_EQ(1, arena.size());
+}
+
+TEST_F(NoDangleArenaTest, Reset) {
+  NoDangleArena arena;
+  std::vector<ObjectPtr> observers;
+  for (int i = 0; i < 100; ++i) {
+    ObjectPtr p = arena.make<TestObject>(i);
+    for (int j = 0; j < 10; ++j) {
+      observers.push_back(p);
+    }
+  }
+  EXPECT_EQ(100, arena.size());
+
+  arena.reset();
+  EXPECT_EQ(0, arena.size());
+  for (const auto& p : observers) {
+    EXPECT_FALSE(static_cast<bool>(p));
+    EXPECT_EQ(nullptr, p.get());
+    EXPECT_FALSE(static_cast<bool>(p.pin()));
+  }
+}
+
+TEST_F(NoDangleArenaTest, ResetDestroys) {
+  bool first_deleted = false;
+  bool second_deleted = false;
+  NoDangleArena arena;
+  auto p = arena.make<DestructionTracker>(&first_deleted);
+  auto q = arena.make<DestructionTracker>(&second_deleted);
+  EXPECT_FALSE(first_deleted);
+  EXPECT_FALSE(second_deleted);
+  arena.reset();
+  EXPECT_TRUE(first_deleted);
+  EXPECT_TRUE(second_deleted);
+}
+
+TEST_F(NoDangleArenaTest, Reuse) {
+  NoDangleArena arena;
+  ObjectPtr old = arena.make<TestObject>(magic);
+  arena.reset();
+
+  ObjectPtr p = arena.make<TestObject>(magic + 1);
+  EXPECT_FALSE(static_cast<bool>(old));
+  EXPECT_EQ(magic + 1, *p);
+  EXPECT_EQ(1, arena.size());
+}
+
+TEST_F(NoDangleArenaTest, Destructor) {
+  bool deleted = false;
+  NoDanglePtr<DestructionTracker> p;
+  {
+    NoDangleArena arena;
+    p = arena.make<DestructionTracker>(&deleted);
+  }
+  EXPECT_TRUE(deleted);
+  EXPECT_FALSE(static_cast<bool>(p));
+}
+
+TEST_F(NoDangleArenaTest, ObserverOutlivesArena) {
+  ObjectPtr observer;
+  {
+    NoDangleArena arena;
+    observer = arena.make<TestObject>(magic);
+    ObjectPtr copy = observer;
+  }
+  ObjectPtr copy = observer;
+  EXPECT_FALSE(static_cast<bool>(copy));
+}
+
+} // namespace ct::test
@@ -0,0 +1,213 @@
+#include "list-ptr-serialization.h"
+#include "list-ptr.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace ct::test {
+
+namespace {
+
+struct Node {
+  void save(OutputArchive& out) const {
+    ++saves;
+    out.write(value);
+    out.write(left);
+    out.write(right);
+  }
+
+  void load(InputArchive& in) {
+    in.read(value);
+    in.read(left);
+    in.read(right);
+  }
+
+  int value = 0;
+  ListPtr<Node> left;
+  ListPtr<Node> right;
+
+  inline static std::size_t saves = 0;
+};
+
+ListPtr<Node> makeNode(int value, ListPtr<Node> left = nullptr, ListPtr<Node> right = nullptr) {
+  auto node = makeListPtr<Node>();
+  node->value = value;
+  node->left = std::move(left);
+  node->right = std::move(right);
+  return node;
+}
+
+template <typename T>
+ListPtr<T> roundTrip(const ListPtr<T>& root) {
+  std::stringstream stream;
+  serialize(stream, root);
+  return deserialize<T>(stream);
+}
+
+} // namespace
+
+TEST(SerializationTest, Null) {
+  auto root = roundTrip(ListPtr<Node>());
+  EXPECT_FALSE(static_cast<bool>(root));
+}
+
+TEST(SerializationTest, TriviallyCopyable) {
+  auto root = roundTrip(makeListPtr<double>(4.2));
+  ASSERT_TRUE(static_cast<bool>(root));
+  EXPECT_EQ(4.2, *root);
+  EXPECT_EQ(1, root.useCount());
+}
+
+TEST(SerializationTest, Tree) {
+  auto root = roundTrip(makeNode(1, makeNode(2), makeNode(3, makeNode(4))));
+  ASSERT_TRUE(static_cast<bool>(root));
+  EXPECT_EQ(1, root->value);
+  EXPECT_EQ(2, root->left->value);
+  EXPECT_FALSE(static_cast<bool>(root->left->left));
+  EXPECT_EQ(3, root->right->value);
+  EXPECT_EQ(4, root->right->left->value);
+  EXPECT_EQ(1, root->right.useCount());
+}
+
+TEST(SerializationTest, SharingPreserved) {
+  auto shared = makeNode(42);
+  auto root = makeNode(1, makeNode(2, shared), makeNode(3, shared, shared));
+  EXPECT_EQ(4, shared.useCount());
+  shared.reset();
+
+  Node::saves = 0;
+  auto loaded = roundTrip(root);
+  EXPECT_EQ(4, Node::saves);
+
+  const auto& loaded_shared = loaded->left->left;
+  EXPECT_EQ(42, loaded_shared->value);
+  EXPECT_EQ(loaded_shared.get(), loaded->right->left.get());
+  EXPECT_EQ(loaded_shared.get(), loaded->right->right.get());
+  EXPECT_EQ(3, loaded_shared.useCount());
+}
+
+TEST(SerializationTest, SharedObjectWrittenOnce) {
+  auto shared = makeNode(42);
+  ListPtr<Node> root = shared;
+  for (int i = 0; i < 1000; ++i) {
+    root = makeNode(i, root, shared);
+  }
+
+  Node::saves = 0;
+  std::stringstream stream;
+  serialize(stream, root);
+  EXPECT_EQ(1001, Node::saves);
+
+  auto loaded = deserialize<Node>(stream);
+  EXPECT_EQ(999, loaded->value);
+  EXPECT_EQ(1001, loaded->right.useCount());
+}
+
+TEST(SerializationTest, FromMemory) {
+  auto root = makeNode(1, makeNode(2));
+  std::stringstream stream;
+  serialize(stream, root);
+  std::string data = stream.str();
+
+  auto loaded = deserialize<Node>(std::as_bytes(std::span(data)));
+  EXPECT_EQ(1, loaded->value);
+  EXPECT_EQ(2, loaded->left->value);
+}
+
+TEST(SerializationTest, Archive) {
+  auto shared = makeListPtr<int>(42);
+  std::stringstream stream;
+  {
+    OutputArchive out(stream);
+    out.write(7);
+    out.write(shared);
+    out.write(shared);
+  }
+
+  InputArchive in(stream);
+  int value = 0;
+  ListPtr<int> first;
+  ListPtr<int> second;
+  in.read(value);
+  in.read(first);
+  in.read(second);
+  EXPECT_EQ(7, value);
+  EXPECT_EQ(42, *first);
+  EXPECT_TRUE(first == second);
+  EXPECT_EQ(2, first.useCount());
+}
+
+TEST(SerializationTest, Malformed) {
+  auto root = makeNode(1, makeNode(2));
+  std::stringstream stream;
+  serialize(stream, root);
+  std::string data = stream.str();
+  data.resize(data.size() / 2);
+
+  std::stringstream truncated(data);
+  EXPECT_THROW(deserialize<Node>(truncated), std::runtime_error);
+}
+
+namespace {
+
+enum class Color { Red, Green };
+
+struct WithPointer {
+  int* ptr;
+};
+
+struct Polymorphic {
+  virtual ~Polymorphic() = default;
+
+  void save(OutputArchive&) const {}
+
+  void load(InputArchive&) {}
+};
+
+template <typename P>
+concept Writable = requires(OutputArchive& out, const P& ptr) { out.write(ptr); };
+
+template <typename P>
+concept Readable = requires(InputArchive& in, P& ptr) { in.read(ptr); };
+
+} // namespace
+
+TEST(SerializationTraitsTest, Serializable) {
+  static_assert(Serializable<int>);
+  static_assert(Serializable<Color>);
+  static_assert(Serializable<double[4]>);
+  static_assert(Serializable<Node>);
+  static_assert(!Serializable<std::string>);
+  static_assert(!Serializable<ListPtr<int>>);
+  static_assert(!Serializable<int*>);
+  static_assert(!Serializable<WithPointer>);
+}
+
+TEST(SerializationTraitsTest, Polymorphic) {
+  static_assert(Serializable<Polymorphic>);
+  static_assert(!SerializableObject<Polymorphic>);
+  static_assert(Writable<ListPtr<Node>>);
+  static_assert(!Writable<ListPtr<Polymorphic>>);
+}
+
+TEST(SerializationTraitsTest, Array) {
+  static_assert(Serializable<int[4]>);
+  static_assert(!SerializableObject<int[]>);
+  static_assert(!SerializableObject<int[4]>);
+  static_assert(!Writable<ListPtr<int[]>>);
+  static_assert(!Writable<ListPtr<int[4]>>);
+  static_assert(!Readable<ListPtr<int[]>>);
+}
+
+TEST(SerializationTraitsTest, Readable) {
+  static_assert(Readable<ListPtr<Node>>);
+  static_assert(Readable<ListPtr<int, std::default_delete<int>, SinglyLinked>>);
+  static_assert(!Readable<ListPtr<Node, void (*)(Node*)>>);
+}
+
+} // namespace ct::test
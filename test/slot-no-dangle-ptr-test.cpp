@@ -0,0 +1,133 @@
+#include "slot-no-dangle-ptr.h"
+#include "test-classes.h"
+#include "test-object.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace ct::test {
+
+class SlotNoDanglePtrTest : public ::testing::Test {
+protected:
+  TestObject::NoNewInstancesGuard instances_guard;
+};
+
+using SlotPtr = SlotNoDanglePtr<TestObject>;
+
+inline static constexpr int magic = 42;
+
+TEST_F(SlotNoDanglePtrTest, DefaultCtor) {
+  SlotPtr p;
+  EXPECT_FALSE(static_cast<bool>(p));
+  EXPECT_EQ(nullptr, p.get());
+  EXPECT_TRUE(p == SlotPtr(nullptr));
+}
+
+TEST_F(SlotNoDanglePtrTest, Make) {
+  SlotPtr p = makeSlotNoDanglePtr<TestObject>(magic);
+  EXPECT_TRUE(static_cast<bool>(p));
+  EXPECT_EQ(magic, *p);
+  EXPECT_EQ(magic, p->operator int());
+  p.destroy();
+}
+
+TEST_F(SlotNoDanglePtrTest, Destroy) {
+  SlotPtr p = makeSlotNoDanglePtr<TestObject>(magic);
+  SlotPtr q = p;
+  SlotPtr r;
+  r = q;
+
+  q.destroy();
+  EXPECT_FALSE(static_cast<bool>(p));
+  EXPECT_FALSE(static_cast<bool>(q));
+  EXPECT_FALSE(static_cast<bool>(r));
+  EXPECT_EQ(nullptr, r.get());
+}
+
+TEST_F(SlotNoDanglePtrTest, DestroyLifetime) {
+  bool deleted = false;
+  auto p = makeSlotNoDanglePtr<DestructionTracker>(&deleted);
+  auto q = p;
+  EXPECT_FALSE(deleted);
+  p.destroy();
+  EXPECT_TRUE(deleted);
+  EXPECT_FALSE(static_cast<bool>(q));
+}
+
+TEST_F(SlotNoDanglePtrTest, DestroyTwice) {
+  SlotPtr p = makeSlotNoDanglePtr<TestObject>(magic);
+  SlotPtr q = p;
+  p.destroy();
+  q.destroy();
+  EXPECT_FALSE(static_cast<bool>(q));
+}
+
+TEST_F(SlotNoDanglePtrTest, DestroyNullptr) {
+  SlotPtr p;
+  p.destroy();
+  EXPECT_FALSE(static_cast<bool>(p));
+}
+
+TEST_F(SlotNoDanglePtrTest, ReusedSlot) {
+  SlotPtr p = makeSlotNoDanglePtr<TestObject>(magic);
+  SlotPtr stale = p;
+  p.destroy();
+
+  SlotPtr q = makeSlotNoDanglePtr<TestObject>(magic + 1);
+  EXPECT_FALSE(static_cast<bool>(stale));
+  EXPECT_FALSE(stale == q);
+  EXPECT_EQ(magic + 1, *q);
+
+  stale.destroy();
+  EXPECT_TRUE(static_cast<bool>(q));
+  q.destroy();
+}
+
+TEST_F(SlotNoDanglePtrTest, Equivalence) {
+  SlotPtr p = makeSlotNoDanglePtr<TestObject>(magic);
+  SlotPtr q = makeSlotNoDanglePtr<TestObject>(magic);
+  SlotPtr r = p;
+  EXPECT_TRUE(p == r);
+  EXPECT_FALSE(p != r);
+  EXPECT_FALSE(p == q);
+  EXPECT_TRUE(p != q);
+  p.destroy();
+  q.destroy();
+}
+
+TEST_F(SlotNoDanglePtrTest, ManyObjects) {
+  constexpr std::size_t count = 1000;
+
+  std::vector<SlotPtr> objects;
+  for (std::size_t i = 0; i < count; ++i) {
+    objects.push_back(makeSlotNoDanglePtr<TestObject>(static_cast<int>(i)));
+  }
+  std::vector<SlotPtr> copies = objects;
+
+  for (std::size_t i = 0; i < count; i += 2) {
+    objects[i].destroy();
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    if (i % 2 == 0) {
+      EXPECT_FALSE(static_cast<bool>(copies[i]));
+    } else {
+      EXPECT_EQ(static_cast<int>(i), *copies[i]);
+    }
+  }
+
+  for (std::size_t i = 1; i < count; i += 2) {
+    copies[i].destroy();
+  }
+}
+
+TEST(SlotNoDanglePtrTraitsTest, Copy) {
+  static_assert(std::is_trivially_copyable_v<SlotNoDanglePtr<int>>);
+  static_assert(std::is_trivially_destructible_v<SlotNoDanglePtr<int>>);
+  static_assert(sizeof(SlotNoDanglePtr<int>) <= 2 * sizeof(void*));
+  static_assert(!std::is_convertible_v<SlotNoDanglePtr<int>, int*>);
+}
+
+} // namespace ct::test
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+
 template <typename T>
 struct TrackingDeleter {
   explicit TrackingDeleter(bool* deleted)
@@ -38,3 +41,41 @@ struct DestructionTracker : DestructionTrackerBase {
 private:
   bool* deleted;
 };
+
+struct AllocationStats {
+  std::size_t allocations = 0;
+  std::size_t deallocations = 0;
+};
+
+template <typename T>
+struct TrackingAllocator {
+  using value_type = T;
+
+  explicit TrackingAllocator(AllocationStats* stats)
+      : stats(stats) {}
+
+  template <typename U>
+  TrackingAllocator(const TrackingAllocator<U>& other)
+      : stats(other.stats) {}
+
+  T* allocate(std::size_t n) {
+    ++stats->allocations;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* ptr, std::size_t n) {
+    ++stats->deallocations;
+    std::allocator<T>().deallocate(ptr, n);
+  }
+
+  template <typename U>
+  friend bool operator==(const TrackingAllocator& lhs, const TrackingAllocator<U>& rhs) {
+    return lhs.stats == rhs.stats;
+  }
+
+private:
+  template <typename U>
+  friend struct TrackingAllocator;
+
+  AllocationStats* stats;
+};
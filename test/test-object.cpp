@@ -2,59 +2,149 @@
 
 #include <gtest/gtest.h>
 
+#include <utility>
+#include <vector>
+
 namespace {
 
 int transcode(int data, const void* ptr) {
   return data ^ static_cast<int>(reinterpret_cast<std::ptrdiff_t>(ptr) / sizeof(ct::test::TestObject));
 }
 
+std::uint64_t mix(const void* ptr) {
+  auto x = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ptr));
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+  return x ^ (x >> 31);
+}
+
 } // namespace
 
 namespace ct::test {
 
+// Open-addressing hash set with linear probing, which also maintains the sum of hashes of its elements,
+// so that two sets are compared in O(1) by their sizes and checksums.
+class TestObject::InstanceSet {
+public:
+  bool insert(const TestObject* object) {
+    if (2 * (count + 1) > slots.size()) {
+      rehash(slots.empty() ? 16 : 2 * slots.size());
+    }
+    std::size_t i = find(object);
+    if (slots[i]) {
+      return false;
+    }
+    slots[i] = object;
+    ++count;
+    sum += mix(object);
+    return true;
+  }
+
+  bool erase(const TestObject* object) {
+    if (slots.empty()) {
+      return false;
+    }
+    std::size_t i = find(object);
+    if (!slots[i]) {
+      return false;
+    }
+    slots[i] = nullptr;
+    --count;
+    sum -= mix(object);
+
+    // Backward shift deletion: moves the following elements of the probe sequence into the hole,
+    // so that no tombstones are needed.
+    std::size_t mask = slots.size() - 1;
+    for (std::size_t j = (i + 1) & mask; slots[j]; j = (j + 1) & mask) {
+      std::size_t home = mix(slots[j]) & mask;
+      bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+      if (!stays) {
+        slots[i] = std::exchange(slots[j], nullptr);
+        i = j;
+      }
+    }
+    return true;
+  }
+
+  bool contains(const TestObject* object) const {
+    return !slots.empty() && slots[find(object)] == object;
+  }
+
+  std::size_t size() const {
+    return count;
+  }
+
+  std::uint64_t checksum() const {
+    return sum;
+  }
+
+private:
+  // Returns the slot of `object`, or the empty slot, where it would be inserted.
+  std::size_t find(const TestObject* object) const {
+    std::size_t mask = slots.size() - 1;
+    std::size_t i = mix(object) & mask;
+    while (slots[i] && slots[i] != object) {
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  void rehash(std::size_t capacity) {
+    std::vector<const TestObject*> old = std::exchange(slots, std::vector<const TestObject*>(capacity, nullptr));
+    for (const TestObject* object : old) {
+      if (object) {
+        slots[find(object)] = object;
+      }
+    }
+  }
+
+  std::vector<const TestObject*> slots;
+  std::size_t count = 0;
+  std::uint64_t sum = 0;
+};
+
 TestObject::TestObject(int data)
     : data(transcode(data, this)) {
-  auto p = instances.insert(this);
-  EXPECT_TRUE(p.second);
+  EXPECT_TRUE(instances.insert(this));
 }
 
 TestObject::TestObject(const TestObject& other) {
   {
-    EXPECT_TRUE(instances.find(&other) != instances.end());
-    auto p = instances.insert(this);
-    EXPECT_TRUE(p.second);
+    EXPECT_TRUE(instances.contains(&other));
+    EXPECT_TRUE(instances.insert(this));
   }
   data = transcode(transcode(other.data, &other), this);
 }
 
 TestObject::~TestObject() {
-  size_t n = instances.erase(this);
-  EXPECT_EQ(1u, n);
+  EXPECT_TRUE(instances.erase(this));
 }
 
 TestObject& TestObject::operator=(const TestObject& c) {
-  EXPECT_TRUE(instances.find(this) != instances.end());
+  EXPECT_TRUE(instances.contains(this));
   data = transcode(transcode(c.data, &c), this);
   return *this;
 }
 
 TestObject::operator int() const {
-  EXPECT_TRUE(instances.find(this) != instances.end());
+  EXPECT_TRUE(instances.contains(this));
 
   return transcode(data, this);
 }
 
-std::set<const TestObject*> TestObject::instances;
+TestObject::InstanceSet TestObject::instances;
 
 TestObject::NoNewInstancesGuard::NoNewInstancesGuard()
-    : old_instances(instances) {}
+    : old_size(instances.size())
+    , old_checksum(instances.checksum()) {}
 
 TestObject::NoNewInstancesGuard::~NoNewInstancesGuard() {
-  EXPECT_TRUE(old_instances == instances);
+  expect_no_instances();
 }
 
 void TestObject::NoNewInstancesGuard::expect_no_instances() const {
-  EXPECT_TRUE(old_instances == instances);
+  EXPECT_EQ(old_size, instances.size());
+  EXPECT_EQ(old_checksum, instances.checksum());
 }
 
 } // namespace ct::test
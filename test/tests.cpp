@@ -4,6 +4,11 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <sstream>
+#include <string>
+#include <vector>
+
 namespace ct::test {
 
 class ListPtrTest : public ::testing::Test {
@@ -41,6 +46,24 @@ TEST_F(ListPtrTest, PtrCtorNonEmptyNullptr) {
   EXPECT_EQ(1, p.useCount());
 }
 
+TEST_F(ListPtrTest, Unique) {
+  Ptr p(new TestObject(magic));
+  EXPECT_TRUE(p.unique());
+  {
+    Ptr q = p;
+    EXPECT_FALSE(p.unique());
+    EXPECT_FALSE(q.unique());
+  }
+  EXPECT_TRUE(p.unique());
+}
+
+TEST_F(ListPtrTest, UniqueNullptr) {
+  Ptr p;
+  EXPECT_FALSE(p.unique());
+  Ptr q(static_cast<TestObject*>(nullptr));
+  EXPECT_TRUE(q.unique());
+}
+
 TEST_F(ListPtrTest, ConstDereferencing) {
   const Ptr p(new TestObject(magic));
   EXPECT_EQ(42, *p);
@@ -210,6 +233,126 @@ TEST_F(ListPtrTest, MakeSharedForwarding) {
   EXPECT_EQ(p->y, 3.14);
 }
 
+TEST_F(ListPtrTest, MakeSharedForOverwrite) {
+  struct DefaultConstructible {
+    DefaultConstructible()
+        : data(magic) {}
+
+    int data;
+  };
+
+  ListPtr<DefaultConstructible> p = makeListPtrForOverwrite<DefaultConstructible>();
+  EXPECT_EQ(magic, p->data);
+  EXPECT_EQ(1, p.useCount());
+}
+
+TEST_F(ListPtrTest, MakeSharedForOverwriteTrivial) {
+  ListPtr<int> p = makeListPtrForOverwrite<int>();
+  EXPECT_TRUE(static_cast<bool>(p));
+  *p = magic;
+  EXPECT_EQ(magic, *p);
+}
+
+TEST_F(ListPtrTest, AllocateShared) {
+  AllocationStats stats;
+  {
+    auto p = allocateListPtr<TestObject>(TrackingAllocator<TestObject>(&stats), magic);
+    EXPECT_EQ(magic, *p);
+    EXPECT_EQ(1, stats.allocations);
+    {
+      auto q = p;
+      p.reset();
+      EXPECT_EQ(magic, *q);
+      EXPECT_EQ(0, stats.deallocations);
+    }
+    EXPECT_EQ(1, stats.deallocations);
+  }
+  EXPECT_EQ(1, stats.allocations);
+  EXPECT_EQ(1, stats.deallocations);
+}
+
+TEST_F(ListPtrTest, AllocateSharedDerived) {
+  AllocationStats stats;
+  bool deleted = false;
+  {
+    auto p = allocateListPtr<DestructionTracker>(TrackingAllocator<DestructionTrackerBase>(&stats), &deleted);
+    auto q = std::move(p);
+    EXPECT_FALSE(deleted);
+  }
+  EXPECT_TRUE(deleted);
+  EXPECT_EQ(1, stats.allocations);
+  EXPECT_EQ(1, stats.deallocations);
+}
+
+TEST_F(ListPtrTest, AliasingCtor) {
+  struct Pair {
+    Pair(int first, int second)
+        : first(first)
+        , second(second) {}
+
+    TestObject first;
+    TestObject second;
+  };
+
+  ListPtr<Pair> p = makeListPtr<Pair>(magic, magic + 1);
+  Ptr q(p, &p->second);
+  EXPECT_EQ(&p->second, q.get());
+  EXPECT_EQ(magic + 1, *q);
+  EXPECT_EQ(2, p.useCount());
+  EXPECT_EQ(2, q.useCount());
+
+  p.reset();
+  EXPECT_EQ(1, q.useCount());
+  EXPECT_EQ(magic + 1, *q);
+}
+
+TEST_F(ListPtrTest, AliasingMoveCtor) {
+  struct Pair {
+    Pair(int first, int second)
+        : first(first)
+        , second(second) {}
+
+    TestObject first;
+    TestObject second;
+  };
+
+  ListPtr<Pair> p = makeListPtr<Pair>(magic, magic + 1);
+  TestObject* alias = &p->first;
+  Ptr q(std::move(p), alias);
+  EXPECT_FALSE(static_cast<bool>(p));
+  EXPECT_EQ(alias, q.get());
+  EXPECT_EQ(magic, *q);
+  EXPECT_EQ(1, q.useCount());
+}
+
+TEST_F(ListPtrTest, AliasingCtorArrayElement) {
+  ListPtr<std::array<int, 4>> buffer = makeListPtr<std::array<int, 4>>(std::array{1, 2, 3, 4});
+  ListPtr<const int> element(buffer, buffer->data() + 2);
+  buffer.reset();
+  EXPECT_EQ(3, *element);
+  EXPECT_EQ(1, element.useCount());
+}
+
+TEST_F(ListPtrTest, AliasingCtorLifetime) {
+  bool deleted = false;
+  {
+    ListPtr<DestructionTracker> p(new DestructionTracker(&deleted));
+    int value = magic;
+    ListPtr<int> q(p, &value);
+    p.reset();
+    EXPECT_FALSE(deleted);
+    EXPECT_EQ(magic, *q);
+  }
+  EXPECT_TRUE(deleted);
+}
+
+TEST_F(ListPtrTest, AliasingCtorEmptyOwner) {
+  int value = magic;
+  ListPtr<int> p(ListPtr<double>(), &value);
+  EXPECT_EQ(&value, p.get());
+  EXPECT_EQ(0, p.useCount());
+}
+
 TEST_F(ListPtrTest, PtrCtorInheritance) {
   bool deleted = false;
   { ListPtr<DestructionTrackerBase> p(new DestructionTracker(&deleted)); }
@@ -453,6 +596,464 @@ TEST_F(ListPtrTest, CheckLifetime) {
   EXPECT_TRUE(deleted);
 }
 
+TEST_F(ListPtrTest, ResetAll) {
+  Ptr p(new TestObject(magic));
+  Ptr q = p;
+  ListPtr<const TestObject> r = p;
+  ListWeakPtr<TestObject> w = p;
+  q.resetAll();
+  EXPECT_FALSE(static_cast<bool>(p));
+  EXPECT_FALSE(static_cast<bool>(q));
+  EXPECT_FALSE(static_cast<bool>(r));
+  EXPECT_TRUE(w.expired());
+}
+
+TEST_F(ListPtrTest, ResetAllLifetime) {
+  bool deleted = false;
+  ListPtr<DestructionTracker> p(new DestructionTracker(&deleted));
+  ListPtr<DestructionTrackerBase> q = p;
+  q.resetAll();
+  EXPECT_TRUE(deleted);
+  EXPECT_FALSE(static_cast<bool>(p));
+}
+
+TEST_F(ListPtrTest, ResetAllNullptr) {
+  Ptr p;
+  p.resetAll();
+  EXPECT_FALSE(static_cast<bool>(p));
+}
+
+using WeakPtr = ListWeakPtr<TestObject>;
+
+TEST_F(ListPtrTest, WeakDefaultCtor) {
+  WeakPtr w;
+  EXPECT_TRUE(w.expired());
+  EXPECT_EQ(0, w.useCount());
+  EXPECT_FALSE(static_cast<bool>(w.lock()));
+}
+
+TEST_F(ListPtrTest, WeakLock) {
+  Ptr p(new TestObject(magic));
+  WeakPtr w = p;
+  EXPECT_FALSE(w.expired());
+  EXPECT_EQ(1, p.useCount());
+  EXPECT_EQ(1, w.useCount());
+  EXPECT_TRUE(p.unique());
+
+  Ptr q = w.lock();
+  EXPECT_TRUE(p == q);
+  EXPECT_EQ(magic, *q);
+  EXPECT_EQ(2, p.useCount());
+  EXPECT_EQ(2, w.useCount());
+}
+
+TEST_F(ListPtrTest, WeakExpired) {
+  Ptr p(new TestObject(magic));
+  WeakPtr w = p;
+  p.reset();
+  EXPECT_TRUE(w.expired());
+  EXPECT_EQ(0, w.useCount());
+  EXPECT_FALSE(static_cast<bool>(w.lock()));
+}
+
+TEST_F(ListPtrTest, WeakExpiredAfterAllOwners) {
+  Ptr p(new TestObject(magic));
+  WeakPtr w = p;
+  {
+    Ptr q = p;
+    WeakPtr v = q;
+    p.reset();
+    EXPECT_FALSE(w.expired());
+    EXPECT_EQ(magic, *w.lock());
+  }
+  EXPECT_TRUE(w.expired());
+}
+
+TEST_F(ListPtrTest, WeakDoesNotExtendLifetime) {
+  bool deleted = false;
+  ListWeakPtr<DestructionTracker> w;
+  {
+    ListPtr<DestructionTracker> p(new DestructionTracker(&deleted));
+    w = p;
+  }
+  EXPECT_TRUE(deleted);
+  EXPECT_TRUE(w.expired());
+}
+
+TEST_F(ListPtrTest, WeakCopyCtor) {
+  Ptr p(new TestObject(magic));
+  WeakPtr w = p;
+  WeakPtr v = w;
+  EXPECT_FALSE(w.expired());
+  EXPECT_FALSE(v.expired());
+  EXPECT_TRUE(p == v.lock());
+  p.reset();
+  EXPECT_TRUE(w.expired());
+  EXPECT_TRUE(v.expired());
+}
+
+TEST_F(ListPtrTest, WeakMoveCtor) {
+  Ptr p(new TestObject(magic));
+  WeakPtr w = p;
+  WeakPtr v = std::move(w);
+  EXPECT_TRUE(w.expired());
+  EXPECT_FALSE(v.expired());
+  EXPECT_TRUE(p == v.lock());
+}
+
+TEST_F(ListPtrTest, WeakAssignment) {
+  Ptr p(new TestObject(magic));
+  Ptr q(new TestObject(magic + 1));
+  WeakPtr w = p;
+  WeakPtr v = q;
+  w = v;
+  EXPECT_TRUE(q == w.lock());
+  w = p;
+  EXPECT_TRUE(p == w.lock());
+  v = std::move(w);
+  EXPECT_TRUE(w.expired());
+  EXPECT_TRUE(p == v.lock());
+}
+
+TEST_F(ListPtrTest, WeakReset) {
+  Ptr p(new TestObject(magic));
+  WeakPtr w = p;
+  w.reset();
+  EXPECT_TRUE(w.expired());
+  EXPECT_EQ(1, p.useCount());
+}
+
+TEST_F(ListPtrTest, WeakInheritance) {
+  bool deleted = false;
+  {
+    ListPtr<DestructionTracker> d(new DestructionTracker(&deleted));
+    ListWeakPtr<DestructionTrackerBase> w = d;
+    ListWeakPtr<const DestructionTrackerBase> v = w;
+    EXPECT_EQ(d.get(), w.lock().get());
+    EXPECT_EQ(d.get(), v.lock().get());
+  }
+  EXPECT_TRUE(deleted);
+}
+
+TEST_F(ListPtrTest, WeakBreaksCycle) {
+  struct Node {
+    explicit Node(bool* deleted)
+        : tracker(deleted) {}
+
+    DestructionTracker tracker;
+    ListPtr<Node> child;
+    ListWeakPtr<Node> parent;
+  };
+
+  bool parent_deleted = false;
+  bool child_deleted = false;
+  {
+    auto parent = makeListPtr<Node>(&parent_deleted);
+    parent->child = makeListPtr<Node>(&child_deleted);
+    parent->child->parent = parent;
+    EXPECT_TRUE(parent == parent->child->parent.lock());
+  }
+  EXPECT_TRUE(parent_deleted);
+  EXPECT_TRUE(child_deleted);
+}
+
+using SinglyLinkedPtr = ListPtr<TestObject, std::default_delete<TestObject>, SinglyLinked>;
+using SinglyLinkedTracker = ListPtr<DestructionTracker, std::default_delete<DestructionTracker>, SinglyLinked>;
+using SinglyLinkedTrackerBase =
+    ListPtr<DestructionTrackerBase, std::default_delete<DestructionTrackerBase>, SinglyLinked>;
+
+TEST_F(ListPtrTest, SinglyLinkedCopy) {
+  SinglyLinkedPtr p(new TestObject(magic));
+  EXPECT_TRUE(p.unique());
+  SinglyLinkedPtr q = p;
+  SinglyLinkedPtr r = q;
+  EXPECT_TRUE(p == r);
+  EXPECT_EQ(3, p.useCount());
+  EXPECT_FALSE(p.unique());
+  EXPECT_EQ(magic, *r);
+}
+
+TEST_F(ListPtrTest, SinglyLinkedDestructionOrder) {
+  bool deleted = false;
+  {
+    SinglyLinkedTracker p(new DestructionTracker(&deleted));
+    std::vector<SinglyLinkedTracker> owners(5, p);
+    EXPECT_EQ(6, p.useCount());
+
+    owners.erase(owners.begin() + 2);
+    EXPECT_EQ(5, p.useCount());
+    owners.erase(owners.begin());
+    EXPECT_EQ(4, p.useCount());
+    owners.pop_back();
+    EXPECT_EQ(3, p.useCount());
+
+    p.reset();
+    EXPECT_EQ(2, owners.front().useCount());
+    EXPECT_FALSE(deleted);
+    owners.front().reset();
+    EXPECT_TRUE(owners.back().unique());
+    EXPECT_FALSE(deleted);
+  }
+  EXPECT_TRUE(deleted);
+}
+
+TEST_F(ListPtrTest, SinglyLinkedMove) {
+  SinglyLinkedPtr p(new TestObject(magic));
+  SinglyLinkedPtr q = p;
+  SinglyLinkedPtr r = std::move(p);
+  EXPECT_FALSE(static_cast<bool>(p));
+  EXPECT_EQ(2, q.useCount());
+  EXPECT_TRUE(q == r);
+
+  p = std::move(r);
+  EXPECT_FALSE(static_cast<bool>(r));
+  EXPECT_EQ(2, q.useCount());
+  EXPECT_EQ(magic, *p);
+}
+
+TEST_F(ListPtrTest, SinglyLinkedAssignment) {
+  SinglyLinkedPtr p(new TestObject(magic));
+  SinglyLinkedPtr q = p;
+  SinglyLinkedPtr r(new TestObject(magic + 1));
+  q = r;
+  EXPECT_EQ(1, p.useCount());
+  EXPECT_EQ(2, r.useCount());
+  p = r;
+  EXPECT_EQ(3, r.useCount());
+  EXPECT_EQ(magic + 1, *p);
+}
+
+TEST_F(ListPtrTest, SinglyLinkedInheritance) {
+  bool deleted = false;
+  {
+    SinglyLinkedTracker d(new DestructionTracker(&deleted));
+    {
+      SinglyLinkedTrackerBase b = d;
+      EXPECT_EQ(d.get(), b.get());
+      EXPECT_EQ(2, d.useCount());
+    }
+    EXPECT_FALSE(deleted);
+  }
+  EXPECT_TRUE(deleted);
+}
+
+TEST_F(ListPtrTest, SinglyLinkedWeak) {
+  SinglyLinkedPtr p(new TestObject(magic));
+  ListWeakPtr<TestObject, SinglyLinked> w = p;
+  EXPECT_EQ(1, p.useCount());
+  EXPECT_TRUE(p == w.lock());
+  p.reset();
+  EXPECT_TRUE(w.expired());
+}
+
+using HybridPtr = ListPtr<TestObject, std::default_delete<TestObject>, HybridLinked<4>>;
+using HybridTracker = ListPtr<DestructionTracker, std::default_delete<DestructionTracker>, HybridLinked<4>>;
+using HybridTrackerBase = ListPtr<DestructionTrackerBase, std::default_delete<DestructionTrackerBase>, HybridLinked<4>>;
+
+TEST_F(ListPtrTest, HybridBelowThreshold) {
+  HybridPtr p(new TestObject(magic));
+  std::vector<HybridPtr> owners(3, p);
+  EXPECT_EQ(4, p.useCount());
+  owners.pop_back();
+  EXPECT_EQ(3, p.useCount());
+  EXPECT_EQ(magic, *owners.front());
+}
+
+TEST_F(ListPtrTest, HybridPromotion) {
+  HybridPtr p(new TestObject(magic));
+  std::vector<HybridPtr> owners;
+  for (std::size_t i = 1; i < 100; ++i) {
+    owners.push_back(p);
+    EXPECT_EQ(i + 1, p.useCount());
+    EXPECT_EQ(i + 1, owners.front().useCount());
+  }
+  EXPECT_FALSE(p.unique());
+  while (!owners.empty()) {
+    owners.pop_back();
+    EXPECT_EQ(owners.size() + 1, p.useCount());
+  }
+  EXPECT_TRUE(p.unique());
+  EXPECT_EQ(magic, *p);
+}
+
+TEST_F(ListPtrTest, HybridDestruction) {
+  bool deleted = false;
+  {
+    HybridTracker p(new DestructionTracker(&deleted));
+    std::vector<HybridTrackerBase> owners(10, p);
+    p.reset();
+    owners.resize(1);
+    EXPECT_FALSE(deleted);
+  }
+  EXPECT_TRUE(deleted);
+}
+
+TEST_F(ListPtrTest, HybridAssignment) {
+  HybridPtr p(new TestObject(magic));
+  HybridPtr q(new TestObject(magic + 1));
+  std::vector<HybridPtr> owners(10, p);
+  for (auto& owner : owners) {
+    owner = q;
+  }
+  EXPECT_EQ(1, p.useCount());
+  EXPECT_EQ(11, q.useCount());
+  HybridPtr r = std::move(owners.back());
+  EXPECT_EQ(11, q.useCount());
+  EXPECT_TRUE(r == q);
+}
+
+TEST_F(ListPtrTest, HybridWeak) {
+  HybridPtr p(new TestObject(magic));
+  ListWeakPtr<TestObject, HybridLinked<4>> w = p;
+  std::vector<HybridPtr> owners(10, p);
+  EXPECT_EQ(11, w.useCount());
+  owners.clear();
+  EXPECT_TRUE(p == w.lock());
+  p.reset();
+  EXPECT_TRUE(w.expired());
+}
+
+TEST_F(ListPtrTest, ManyObjects) {
+  constexpr int objects_count = 1 << 16;
+  std::vector<Ptr> owners;
+  owners.reserve(2 * objects_count);
+  for (int i = 0; i < objects_count; ++i) {
+    Ptr p(new TestObject(i));
+    owners.push_back(p);
+    owners.push_back(std::move(p));
+  }
+  for (int i = 0; i < objects_count; ++i) {
+    ASSERT_EQ(i, *owners[2 * i]);
+    ASSERT_EQ(2, owners[2 * i + 1].useCount());
+  }
+  for (int i = 0; i < objects_count; ++i) {
+    owners[2 * i].reset();
+  }
+  owners.clear();
+  instances_guard.expect_no_instances();
+}
+
+TEST_F(ListPtrTest, Array) {
+  ListPtr<int[]> p(new int[4]{1, 2, 3, 4});
+  ListPtr<int[]> q = p;
+  EXPECT_EQ(2, q.useCount());
+  EXPECT_EQ(p.get(), q.get());
+  EXPECT_EQ(3, q[2]);
+  q[2] = 5;
+  EXPECT_EQ(5, p[2]);
+}
+
+TEST_F(ListPtrTest, ArrayDestruction) {
+  {
+    ListPtr<TestObject[]> p(new TestObject[3]{TestObject(magic), TestObject(magic + 1), TestObject(magic + 2)});
+    ListPtr<TestObject[]> q = p;
+    p.reset();
+    EXPECT_EQ(magic + 2, q[2]);
+  }
+  instances_guard.expect_no_instances();
+}
+
+TEST_F(ListPtrTest, MakeUnboundedArray) {
+  auto p = makeListPtr<int[]>(5);
+  static_assert(std::is_same_v<decltype(p), ListPtr<int[]>>);
+  for (std::size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(0, p[i]);
+  }
+  auto q = p;
+  q[4] = magic;
+  EXPECT_EQ(magic, p[4]);
+}
+
+TEST_F(ListPtrTest, MakeBoundedArray) {
+  auto p = makeListPtr<int[3]>();
+  static_assert(std::is_same_v<decltype(p), ListPtr<int[3]>>);
+  for (std::size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(0, p[i]);
+  }
+  EXPECT_EQ(1, p.useCount());
+}
+
+struct DestructionCounter {
+  ~DestructionCounter() {
+    ++destroyed;
+  }
+
+  inline static std::size_t destroyed = 0;
+};
+
+TEST_F(ListPtrTest, MakeArrayDestruction) {
+  DestructionCounter::destroyed = 0;
+  {
+    auto p = makeListPtr<DestructionCounter[]>(3);
+    auto q = makeListPtr<DestructionCounter[2]>();
+    auto r = p;
+  }
+  EXPECT_EQ(5, DestructionCounter::destroyed);
+}
+
+#ifdef CT_LIST_PTR_DIAGNOSTICS
+TEST_F(ListPtrTest, ValidateRing) {
+  Ptr p(new TestObject(magic));
+  EXPECT_TRUE(p.validateRing());
+  {
+    Ptr q = p;
+    Ptr r = q;
+    r = Ptr(new TestObject(magic));
+    EXPECT_TRUE(p.validateRing());
+    EXPECT_TRUE(r.validateRing());
+  }
+  EXPECT_TRUE(p.validateRing());
+  EXPECT_TRUE(Ptr().validateRing());
+}
+
+TEST_F(ListPtrTest, DumpOwners) {
+  Ptr p(new TestObject(magic));
+  Ptr q = p;
+  std::ostringstream out;
+  p.dumpOwners(out);
+  std::string dump = out.str();
+
+  std::ostringstream p_address;
+  p_address << static_cast<const void*>(&p);
+  std::ostringstream q_address;
+  q_address << static_cast<const void*>(&q);
+  EXPECT_NE(std::string::npos, dump.find(p_address.str()));
+  EXPECT_NE(std::string::npos, dump.find(q_address.str()));
+}
+
+TEST_F(ListPtrTest, Stats) {
+  resetListPtrStats();
+  Ptr p(new TestObject(magic));
+  std::vector<Ptr> owners(99, p);
+  EXPECT_EQ(100, p.useCount());
+
+  ListPtrStats stats = listPtrStats();
+  EXPECT_EQ(100, stats.max_ring_size);
+  EXPECT_EQ(1, stats.ring_sizes[6]);
+
+  owners.clear();
+  stats = listPtrStats();
+  EXPECT_EQ(99, stats.unlinks);
+  EXPECT_EQ(99, stats.unlink_steps);
+
+  resetListPtrStats();
+  stats = listPtrStats();
+  EXPECT_EQ(0, stats.max_ring_size);
+  EXPECT_EQ(0, stats.unlinks);
+}
+
+TEST_F(ListPtrTest, SinglyLinkedStats) {
+  resetListPtrStats();
+  SinglyLinkedPtr p(new TestObject(magic));
+  std::vector<SinglyLinkedPtr> owners(7, p);
+  owners.clear();
+  ListPtrStats stats = listPtrStats();
+  EXPECT_EQ(7, stats.unlinks);
+  EXPECT_LE(stats.unlinks, stats.unlink_steps);
+  EXPECT_TRUE(p.validateRing());
+}
+#endif
+
 TEST(TraitsTest, Ctors) {
   static_assert(std::is_constructible_v<ListPtr<int>, int*>);
   static_assert(std::is_constructible_v<ListPtr<int>, int*, std::default_delete<int>>);
@@ -468,8 +1069,118 @@ TEST(TraitsTest, Ctors) {
                 std::default_delete<DestructionTracker>>);
 }
 
+template <typename P>
+concept Indexable = requires(const P& p) { p[0]; };
+
+template <typename P>
+concept Dereferenceable = requires(const P& p) { *p; };
+
+TEST(TraitsTest, Array) {
+  static_assert(std::is_same_v<ListPtr<int[]>::element_type, int>);
+  static_assert(std::is_same_v<ListPtr<int[4]>::element_type, int>);
+  static_assert(std::is_same_v<ListPtr<int>::element_type, int>);
+  static_assert(std::is_constructible_v<ListPtr<int[]>, int*>);
+  static_assert(std::is_constructible_v<ListPtr<const int[]>, int*>);
+  static_assert(std::is_constructible_v<ListPtr<int[4]>, int*>);
+  static_assert(!std::is_constructible_v<ListPtr<DestructionTrackerBase[]>, DestructionTracker*>);
+  static_assert(!std::is_constructible_v<ListPtr<DestructionTrackerBase[4]>, DestructionTracker*>);
+  static_assert(!std::is_constructible_v<ListPtr<DestructionTrackerBase[]>, ListPtr<DestructionTracker[]>>);
+  static_assert(std::is_constructible_v<ListPtr<const int[]>, ListPtr<int[]>>);
+  static_assert(std::is_same_v<ListPtr<int[]>, ListPtr<int[], std::default_delete<int[]>>>);
+  static_assert(std::is_same_v<ListPtr<int[4]>, ListPtr<int[4], std::default_delete<int[]>>>);
+  static_assert(std::is_same_v<ListPtr<int>, ListPtr<int, std::default_delete<int>>>);
+  static_assert(Indexable<ListPtr<int[]>>);
+  static_assert(!Indexable<ListPtr<int>>);
+  static_assert(!Dereferenceable<ListPtr<int[]>>);
+  static_assert(Dereferenceable<ListPtr<int>>);
+}
+
+TEST(TraitsTest, StatelessDeleterSize) {
+  struct EmptyDeleter {
+    void operator()(int* ptr) const {
+      delete ptr;
+    }
+  };
+
+  struct FinalEmptyDeleter final : EmptyDeleter {};
+
+  auto lambda = [](int* ptr) {
+    delete ptr;
+  };
+
+  // Checked at run time, so that a layout miss fails this test instead of the whole build.
+  // Two links, the stored pointer, the owned pointer and the deleter dispatch.
+  EXPECT_LE(sizeof(ListPtr<int>), 5 * sizeof(void*));
+  EXPECT_EQ(sizeof(ListPtr<int>), sizeof(ListPtr<int, EmptyDeleter>));
+  EXPECT_EQ(sizeof(ListPtr<int>), sizeof(ListPtr<int, FinalEmptyDeleter>));
+  EXPECT_EQ(sizeof(ListPtr<int>), sizeof(ListPtr<int, decltype(lambda)>));
+  EXPECT_LE(sizeof(ListPtr<int, void (*)(int*)>), sizeof(ListPtr<int>) + sizeof(void*));
+}
+
+TEST(TraitsTest, AllocatorDeleter) {
+  using Alloc = TrackingAllocator<TestObject>;
+
+  static_assert(std::is_same_v<
+                decltype(allocateListPtr<TestObject>(std::declval<Alloc>(), magic)),
+                ListPtr<TestObject, AllocatorDeleter<Alloc>>>);
+  static_assert(std::is_same_v<
+                decltype(allocateListPtr<TestObject>(std::declval<TrackingAllocator<int>>(), magic)),
+                ListPtr<TestObject, AllocatorDeleter<Alloc>>>);
+  EXPECT_EQ(sizeof(ListPtr<int, AllocatorDeleter<std::allocator<int>>>), sizeof(ListPtr<int>));
+
+  // Owners with other deleters would have nowhere to keep the allocator.
+  using AllocatedPtr = ListPtr<TestObject, AllocatorDeleter<Alloc>>;
+  static_assert(!std::is_constructible_v<ListPtr<TestObject>, AllocatedPtr>);
+  static_assert(!std::is_constructible_v<ListPtr<const TestObject>, const AllocatedPtr&>);
+  static_assert(!std::is_assignable_v<ListPtr<TestObject>&, AllocatedPtr>);
+  static_assert(!std::is_constructible_v<ListPtr<int>, const AllocatedPtr&, int*>);
+  static_assert(!std::is_constructible_v<ListWeakPtr<TestObject>, const AllocatedPtr&>);
+  static_assert(!std::is_constructible_v<
+                ListPtr<TestObject>,
+                ListPtr<TestObject, AllocatorDeleter<std::allocator<TestObject>>>>);
+}
+
 using DestructionTrackerBaseDeleter = std::default_delete<DestructionTrackerBase>;
 
+TEST(TraitsTest, LinksSize) {
+  using SinglyLinkedIntPtr = ListPtr<int, std::default_delete<int>, SinglyLinked>;
+  using DoublyLinkedIntPtr = ListPtr<int, std::default_delete<int>, DoublyLinked>;
+
+  static_assert(std::is_same_v<ListPtr<int>, DoublyLinkedIntPtr>);
+  EXPECT_LE(sizeof(SinglyLinkedIntPtr) + sizeof(void*), sizeof(DoublyLinkedIntPtr));
+}
+
+TEST(TraitsTest, LinksMismatch) {
+  using SinglyLinkedIntPtr = ListPtr<int, std::default_delete<int>, SinglyLinked>;
+
+  static_assert(!std::is_constructible_v<SinglyLinkedIntPtr, ListPtr<int>>);
+  static_assert(!std::is_constructible_v<ListPtr<int>, SinglyLinkedIntPtr>);
+  static_assert(!std::is_assignable_v<SinglyLinkedIntPtr, ListPtr<int>>);
+  static_assert(!std::is_assignable_v<ListPtr<int>, SinglyLinkedIntPtr>);
+
+  using HybridIntPtr = ListPtr<int, std::default_delete<int>, HybridLinked<4>>;
+
+  static_assert(!std::is_constructible_v<HybridIntPtr, ListPtr<int>>);
+  static_assert(!std::is_constructible_v<HybridIntPtr, ListPtr<int, std::default_delete<int>, HybridLinked<8>>>);
+  static_assert(!std::is_assignable_v<ListPtr<int>, HybridIntPtr>);
+}
+
+template <typename P>
+concept GroupResettable = requires(P& p) { p.resetAll(); };
+
+TEST(TraitsTest, HybridGroupOperations) {
+  static_assert(GroupResettable<ListPtr<int>>);
+  static_assert(GroupResettable<ListPtr<int, std::default_delete<int>, SinglyLinked>>);
+  static_assert(!GroupResettable<ListPtr<int, std::default_delete<int>, HybridLinked<4>>>);
+}
+
+TEST(TraitsTest, AliasingCtor) {
+  static_assert(std::is_constructible_v<ListPtr<int>, const ListPtr<double>&, int*>);
+  static_assert(std::is_constructible_v<ListPtr<int>, ListPtr<double>&&, int*>);
+  static_assert(std::is_constructible_v<ListPtr<const int>, const ListPtr<DestructionTracker>&, int*>);
+  static_assert(!std::is_constructible_v<ListPtr<int>, const ListPtr<int>&, double*>);
+}
+
 TEST(TraitsTest, CopyMoveCtor) {
   static_assert(std::is_constructible_v<ListPtr<const int>, ListPtr<int>>);
   static_assert(!std::is_constructible_v<ListPtr<int>, ListPtr<const int>>);
@@ -482,6 +1193,33 @@ TEST(TraitsTest, CopyMoveCtor) {
                 ListPtr<DestructionTracker, DestructionTrackerBaseDeleter>>);
 }
 
+TEST(TraitsTest, WeakCtors) {
+  static_assert(std::is_constructible_v<ListWeakPtr<const int>, ListPtr<int>>);
+  static_assert(std::is_constructible_v<ListWeakPtr<const int>, ListWeakPtr<int>>);
+  static_assert(!std::is_constructible_v<ListWeakPtr<int>, ListPtr<const int>>);
+  static_assert(!std::is_constructible_v<ListWeakPtr<int>, ListWeakPtr<const int>>);
+  static_assert(!std::is_constructible_v<ListWeakPtr<int>, ListPtr<double>>);
+
+  static_assert(std::is_constructible_v<ListWeakPtr<DestructionTrackerBase>, ListPtr<DestructionTracker>>);
+  static_assert(!std::is_constructible_v<ListWeakPtr<DestructionTracker>, ListPtr<DestructionTrackerBase>>);
+  static_assert(!std::is_constructible_v<ListPtr<int>, ListWeakPtr<int>>);
+}
+
+TEST(TraitsTest, Noexcept) {
+  static_assert(std::is_nothrow_default_constructible_v<ListPtr<int>>);
+  static_assert(std::is_nothrow_move_constructible_v<ListPtr<int>>);
+  static_assert(std::is_nothrow_move_assignable_v<ListPtr<int>>);
+  static_assert(std::is_nothrow_destructible_v<ListPtr<int>>);
+  static_assert(std::is_nothrow_constructible_v<ListPtr<DestructionTrackerBase>, ListPtr<DestructionTracker>&&>);
+  static_assert(noexcept(std::declval<ListPtr<int>&>().reset()));
+  static_assert(noexcept(std::declval<const ListPtr<int>&>().get()));
+  static_assert(noexcept(std::declval<const ListPtr<int>&>().unique()));
+
+  static_assert(std::is_nothrow_copy_constructible_v<ListWeakPtr<int>>);
+  static_assert(std::is_nothrow_constructible_v<ListWeakPtr<int>, const ListPtr<int>&>);
+  static_assert(noexcept(std::declval<const ListWeakPtr<int>&>().expired()));
+}
+
 TEST(TraitsTest, Assignment) {
   static_assert(std::is_assignable_v<ListPtr<const int>, ListPtr<int>>);
   static_assert(!std::is_assignable_v<ListPtr<int>, ListPtr<const int>>);